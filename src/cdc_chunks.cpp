@@ -0,0 +1,438 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Content-defined chunking with FastCDC (Xia et al., "FastCDC: a Fast and Efficient Content-Defined Chunking Approach
+// for Data Deduplication", USENIX ATC 2016).
+//
+// A gear rolling hash fp = (fp << 1) + GEAR[byte] is updated per byte; since every byte is shifted out after 64 steps,
+// the top bits of fp depend only on the last 64 bytes, and a chunk ends where they are all zero under a mask. Scanning
+// starts min_size bytes into the chunk (cut-point skipping). Normalized chunking uses a mask with two more bits than
+// log2(avg) before avg bytes and two fewer after, which concentrates chunk sizes around avg.
+//
+// Chunks are hashed in place, straight from the BLOB or from the file read buffer. The gear table is fixed, so chunk
+// boundaries and digests are stable across runs and versions.
+//
+// cdc_chunks is the table function for files and constant BLOBs; cdc_chunk_list is the scalar for BLOB columns and
+// returns the chunks of each value as a list.
+static constexpr idx_t CDC_MAX_CHUNK_SIZE = idx_t(1) << 30;
+static constexpr idx_t CDC_MIN_AVG_SIZE = 64;
+static constexpr idx_t CDC_READ_SIZE = idx_t(4) << 20;
+
+struct GearTable {
+	uint64_t values[256];
+
+	// splitmix64 sequence from a fixed seed
+	constexpr GearTable() : values() {
+		uint64_t state = 0x43444346617374ULL;
+		for (idx_t i = 0; i < 256; i++) {
+			state += 0x9E3779B97F4A7C15ULL;
+			uint64_t z = state;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			values[i] = z ^ (z >> 31);
+		}
+	}
+};
+
+static constexpr GearTable GEAR;
+
+struct CDCParameters {
+	idx_t min_size;
+	idx_t avg_size;
+	idx_t max_size;
+	uint64_t mask_small;
+	uint64_t mask_large;
+
+	CDCParameters(idx_t min_size_p, idx_t avg_size_p, idx_t max_size_p)
+	    : min_size(min_size_p), avg_size(avg_size_p), max_size(max_size_p) {
+		// log2(avg), rounded to the nearest power of two
+		idx_t bits = 0;
+		while ((idx_t(1) << (bits + 1)) <= avg_size) {
+			bits++;
+		}
+		if (bits + 1 < 64 && avg_size - (idx_t(1) << bits) > (idx_t(1) << (bits + 1)) - avg_size) {
+			bits++;
+		}
+		mask_small = ~uint64_t(0) << (64 - (bits + 2));
+		mask_large = ~uint64_t(0) << (64 - (bits - 2));
+	}
+
+	// Length of the chunk starting at data, given available bytes (all remaining bytes, or at least max_size)
+	inline idx_t Cut(const_data_ptr_t data, const idx_t available) const {
+		if (available <= min_size) {
+			return available;
+		}
+		const auto limit = MinValue(available, max_size);
+		const auto normal = MinValue(limit, avg_size);
+		uint64_t fp = 0;
+		idx_t i = min_size;
+		for (; i < normal; i++) {
+			fp = (fp << 1) + GEAR.values[data[i]];
+			if (!(fp & mask_small)) {
+				return i;
+			}
+		}
+		for (; i < limit; i++) {
+			fp = (fp << 1) + GEAR.values[data[i]];
+			if (!(fp & mask_large)) {
+				return i;
+			}
+		}
+		return limit;
+	}
+
+	bool operator==(const CDCParameters &other) const {
+		return min_size == other.min_size && avg_size == other.avg_size && max_size == other.max_size;
+	}
+};
+
+enum class CDCDigestAlgorithm : uint8_t { XXH3_128, RAPIDHASH };
+
+CDCParameters GetCDCParameters(const int64_t min_size, const int64_t avg_size, const int64_t max_size,
+                               const char *function_name) {
+	if (min_size < 1 || avg_size < int64_t(CDC_MIN_AVG_SIZE) || min_size > avg_size || avg_size > max_size ||
+	    max_size > int64_t(CDC_MAX_CHUNK_SIZE)) {
+		throw BinderException("%s: sizes must satisfy 1 <= min <= avg <= max <= %d and avg >= %d", function_name,
+		                      CDC_MAX_CHUNK_SIZE, CDC_MIN_AVG_SIZE);
+	}
+	return CDCParameters(static_cast<idx_t>(min_size), static_cast<idx_t>(avg_size), static_cast<idx_t>(max_size));
+}
+
+CDCDigestAlgorithm GetCDCDigestAlgorithm(const Value &algo, const char *function_name) {
+	const auto name = algo.IsNull() ? string() : StringUtil::Lower(StringValue::Get(algo));
+	if (name == "xxh3_128") {
+		return CDCDigestAlgorithm::XXH3_128;
+	}
+	if (name == "rapidhash") {
+		return CDCDigestAlgorithm::RAPIDHASH;
+	}
+	throw BinderException("%s: unsupported algo '%s', expected xxh3_128 or rapidhash", function_name, name);
+}
+
+LogicalType CDCDigestType(const CDCDigestAlgorithm algorithm) {
+	return algorithm == CDCDigestAlgorithm::XXH3_128 ? LogicalType::UHUGEINT : LogicalType::UBIGINT;
+}
+
+inline void HashCDCChunk(const CDCDigestAlgorithm algorithm, const_data_ptr_t chunk, const idx_t length,
+                         Vector &digest_vector, const idx_t row) {
+	if (algorithm == CDCDigestAlgorithm::XXH3_128) {
+		hash_bytes<uhugeint_t, HashAlgorithm::XXH3_128>(chunk, length,
+		                                                 FlatVector::GetData<uhugeint_t>(digest_vector)[row]);
+	} else {
+		hash_bytes<uint64_t, HashAlgorithm::RAPIDHASH>(chunk, length, FlatVector::GetData<uint64_t>(digest_vector)[row]);
+	}
+}
+
+struct CDCChunksBindData : public TableFunctionData {
+	CDCChunksBindData(CDCParameters parameters_p, CDCDigestAlgorithm algorithm_p)
+	    : parameters(parameters_p), algorithm(algorithm_p) {
+	}
+
+	CDCParameters parameters;
+	CDCDigestAlgorithm algorithm;
+	// Either a single constant BLOB, shared with the bound Value rather than copied, or a list of files
+	bool from_files = false;
+	Value blob;
+	vector<string> paths;
+
+	idx_t SourceCount() const {
+		return from_files ? paths.size() : 1;
+	}
+};
+
+struct CDCChunksGlobalState : public GlobalTableFunctionState {
+	explicit CDCChunksGlobalState(idx_t source_count_p) : source_count(source_count_p) {
+	}
+
+	atomic<idx_t> next_source {0};
+	idx_t source_count;
+
+	idx_t MaxThreads() const override {
+		return MaxValue<idx_t>(source_count, 1);
+	}
+};
+
+// The source a thread is chunking: a window [0, end) of bytes that starts at window_offset in the source
+struct CDCChunksLocalState : public LocalTableFunctionState {
+	bool active = false;
+	idx_t source_idx = 0;
+	const_data_ptr_t data = nullptr;
+	idx_t pos = 0;
+	idx_t end = 0;
+	idx_t window_offset = 0;
+	bool eof = true;
+
+	unique_ptr<FileHandle> handle;
+	AllocatedData buffer;
+
+	// Keep at least max_size bytes ahead of pos unless the file is exhausted
+	void Refill(ClientContext &context, const idx_t max_size) {
+		if (eof || end - pos >= max_size) {
+			return;
+		}
+		auto buffer_ptr = buffer.get();
+		memmove(buffer_ptr, buffer_ptr + pos, end - pos);
+		window_offset += pos;
+		end -= pos;
+		pos = 0;
+		while (end < buffer.GetSize()) {
+			if (context.interrupted) {
+				throw InterruptException();
+			}
+			const auto bytes_read = handle->Read(buffer_ptr + end, buffer.GetSize() - end);
+			if (bytes_read <= 0) {
+				eof = true;
+				handle.reset();
+				break;
+			}
+			end += static_cast<idx_t>(bytes_read);
+		}
+		data = buffer_ptr;
+	}
+};
+
+unique_ptr<FunctionData> CDCChunksBind(ClientContext &context, TableFunctionBindInput &input,
+                                       vector<LogicalType> &return_types, vector<string> &names) {
+	for (auto &value : input.inputs) {
+		if (value.IsNull()) {
+			throw BinderException("cdc_chunks: arguments cannot be NULL");
+		}
+	}
+	auto parameters = GetCDCParameters(input.inputs[1].GetValue<int64_t>(), input.inputs[2].GetValue<int64_t>(),
+	                                   input.inputs[3].GetValue<int64_t>(), "cdc_chunks");
+	auto algorithm = CDCDigestAlgorithm::XXH3_128;
+	for (auto &param : input.named_parameters) {
+		if (param.first == "algo") {
+			algorithm = GetCDCDigestAlgorithm(param.second, "cdc_chunks");
+		}
+	}
+
+	auto result = make_uniq<CDCChunksBindData>(parameters, algorithm);
+	if (input.inputs[0].type().id() == LogicalTypeId::BLOB) {
+		result->blob = input.inputs[0];
+	} else {
+		result->from_files = true;
+		auto &fs = FileSystem::GetFileSystem(context);
+		for (auto &file : fs.GlobFiles(StringValue::Get(input.inputs[0]), context, FileGlobOptions::DISALLOW_EMPTY)) {
+			result->paths.push_back(file.path);
+		}
+		return_types.push_back(LogicalType::VARCHAR);
+		names.push_back("path");
+	}
+	return_types.push_back(LogicalType::UBIGINT);
+	names.push_back("offset");
+	return_types.push_back(LogicalType::UBIGINT);
+	names.push_back("length");
+	return_types.push_back(CDCDigestType(algorithm));
+	names.push_back("digest");
+	return std::move(result);
+}
+
+unique_ptr<GlobalTableFunctionState> CDCChunksInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<CDCChunksBindData>();
+	return make_uniq<CDCChunksGlobalState>(bind_data.SourceCount());
+}
+
+unique_ptr<LocalTableFunctionState> CDCChunksInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                       GlobalTableFunctionState *global_state) {
+	auto &bind_data = input.bind_data->Cast<CDCChunksBindData>();
+	auto result = make_uniq<CDCChunksLocalState>();
+	if (bind_data.from_files) {
+		result->buffer =
+		    Allocator::Get(context.client).Allocate(MaxValue(CDC_READ_SIZE, 2 * bind_data.parameters.max_size));
+	}
+	return std::move(result);
+}
+
+void CDCChunksFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<CDCChunksBindData>();
+	auto &global_state = data.global_state->Cast<CDCChunksGlobalState>();
+	auto &local_state = data.local_state->Cast<CDCChunksLocalState>();
+	auto &parameters = bind_data.parameters;
+
+	const idx_t first_column = bind_data.from_files ? 1 : 0;
+	auto offsets = FlatVector::GetData<uint64_t>(output.data[first_column]);
+	auto lengths = FlatVector::GetData<uint64_t>(output.data[first_column + 1]);
+	auto &digest_vector = output.data[first_column + 2];
+
+	idx_t row = 0;
+	while (row < STANDARD_VECTOR_SIZE) {
+		if (!local_state.active) {
+			local_state.source_idx = global_state.next_source++;
+			if (local_state.source_idx >= bind_data.SourceCount()) {
+				break;
+			}
+			local_state.active = true;
+			local_state.pos = 0;
+			local_state.window_offset = 0;
+			if (bind_data.from_files) {
+				auto &fs = FileSystem::GetFileSystem(context);
+				local_state.handle = fs.OpenFile(bind_data.paths[local_state.source_idx], FileFlags::FILE_FLAGS_READ);
+				local_state.end = 0;
+				local_state.eof = false;
+			} else {
+				auto &blob = StringValue::Get(bind_data.blob);
+				local_state.data = const_data_ptr_cast(blob.data());
+				local_state.end = blob.size();
+				local_state.eof = true;
+			}
+		}
+		if (bind_data.from_files) {
+			local_state.Refill(context, parameters.max_size);
+		}
+		if (local_state.pos == local_state.end) {
+			local_state.active = false;
+			continue;
+		}
+
+		const auto chunk = local_state.data + local_state.pos;
+		const auto length = parameters.Cut(chunk, local_state.end - local_state.pos);
+		if (bind_data.from_files) {
+			FlatVector::GetData<string_t>(output.data[0])[row] =
+			    StringVector::AddString(output.data[0], bind_data.paths[local_state.source_idx]);
+		}
+		offsets[row] = local_state.window_offset + local_state.pos;
+		lengths[row] = length;
+		HashCDCChunk(bind_data.algorithm, chunk, length, digest_vector, row);
+		local_state.pos += length;
+		row++;
+	}
+	output.SetCardinality(row);
+}
+
+struct CDCChunkListBindData : public FunctionData {
+	CDCChunkListBindData(CDCParameters parameters_p, CDCDigestAlgorithm algorithm_p)
+	    : parameters(parameters_p), algorithm(algorithm_p) {
+	}
+
+	CDCParameters parameters;
+	CDCDigestAlgorithm algorithm;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<CDCChunkListBindData>(parameters, algorithm);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<CDCChunkListBindData>();
+		return parameters == other.parameters && algorithm == other.algorithm;
+	}
+};
+
+unique_ptr<FunctionData> CDCChunkListBind(ClientContext &context, ScalarFunction &bound_function,
+                                          vector<unique_ptr<Expression>> &arguments) {
+	auto parameters = GetCDCParameters(
+	    GetConstantArgument(context, *arguments[1], "cdc_chunk_list", "min_size").GetValue<int64_t>(),
+	    GetConstantArgument(context, *arguments[2], "cdc_chunk_list", "avg_size").GetValue<int64_t>(),
+	    GetConstantArgument(context, *arguments[3], "cdc_chunk_list", "max_size").GetValue<int64_t>(),
+	    "cdc_chunk_list");
+	auto algorithm = CDCDigestAlgorithm::XXH3_128;
+	if (arguments.size() > 4) {
+		algorithm =
+		    GetCDCDigestAlgorithm(GetConstantArgument(context, *arguments[4], "cdc_chunk_list", "algo"), "cdc_chunk_list");
+	}
+	bound_function.return_type = LogicalType::LIST(LogicalType::STRUCT(
+	    {{"offset", LogicalType::UBIGINT}, {"length", LogicalType::UBIGINT}, {"digest", CDCDigestType(algorithm)}}));
+	return make_uniq<CDCChunkListBindData>(parameters, algorithm);
+}
+
+void CDCChunkListFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<CDCChunkListBindData>();
+	auto &parameters = bind_data.parameters;
+	const auto row_count = args.size();
+
+	UnifiedVectorFormat blob_vdata;
+	args.data[0].ToUnifiedFormat(row_count, blob_vdata);
+	auto blobs = UnifiedVectorFormat::GetData<string_t>(blob_vdata);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto list_entries = FlatVector::GetData<list_entry_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+	auto list_size = ListVector::GetListSize(result);
+
+	// Cut each value first, then reserve its chunks at once and hash them in place
+	vector<idx_t> lengths;
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto blob_idx = blob_vdata.sel->get_index(i);
+		if (!blob_vdata.validity.RowIsValid(blob_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		const auto &blob = blobs[blob_idx];
+		const auto data = const_data_ptr_cast(blob.GetData());
+		const auto size = blob.GetSize();
+		lengths.clear();
+		for (idx_t pos = 0; pos < size;) {
+			lengths.push_back(parameters.Cut(data + pos, size - pos));
+			pos += lengths.back();
+		}
+
+		ListVector::Reserve(result, list_size + lengths.size());
+		auto &fields = StructVector::GetEntries(ListVector::GetEntry(result));
+		auto offsets = FlatVector::GetData<uint64_t>(*fields[0]);
+		auto chunk_lengths = FlatVector::GetData<uint64_t>(*fields[1]);
+		list_entries[i].offset = list_size;
+		list_entries[i].length = lengths.size();
+		idx_t pos = 0;
+		for (auto length : lengths) {
+			offsets[list_size] = pos;
+			chunk_lengths[list_size] = length;
+			HashCDCChunk(bind_data.algorithm, data + pos, length, *fields[2], list_size);
+			pos += length;
+			list_size++;
+		}
+	}
+	ListVector::SetListSize(result, list_size);
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+} // namespace
+
+void RegisterContentDefinedChunkingFunctions(ExtensionLoader &loader) {
+	TableFunctionSet cdc_chunks("cdc_chunks");
+	for (auto &source_type : {LogicalType::BLOB, LogicalType::VARCHAR}) {
+		TableFunction function({source_type, LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::BIGINT},
+		                       CDCChunksFunction, CDCChunksBind, CDCChunksInitGlobal, CDCChunksInitLocal);
+		function.named_parameters["algo"] = LogicalType::VARCHAR;
+		cdc_chunks.AddFunction(function);
+	}
+	loader.RegisterFunction(cdc_chunks);
+
+	ScalarFunctionSet chunk_list_set("cdc_chunk_list");
+	for (auto &arguments : {vector<LogicalType> {LogicalType::BLOB, LogicalType::BIGINT, LogicalType::BIGINT,
+	                                             LogicalType::BIGINT},
+	                        vector<LogicalType> {LogicalType::BLOB, LogicalType::BIGINT, LogicalType::BIGINT,
+	                                             LogicalType::BIGINT, LogicalType::VARCHAR}}) {
+		chunk_list_set.AddFunction(
+		    ScalarFunction(arguments, LogicalType::LIST(LogicalType::ANY), CDCChunkListFunction, CDCChunkListBind));
+	}
+	CreateScalarFunctionInfo chunk_list_info(chunk_list_set);
+	chunk_list_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::BIGINT,
+	                            LogicalType::VARCHAR},
+	     /* parameter_names */ {"value", "min_size", "avg_size", "max_size", "algo"},
+	     /* description */
+	     "Splits a BLOB into FastCDC content-defined chunks, as cdc_chunks does, and returns them as a list of "
+	     "(offset, length, digest); algo is xxh3_128 (default) or rapidhash",
+	     /* examples */ {"SELECT id, unnest(cdc_chunk_list(content, 16384, 65536, 262144)) FROM objects"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(chunk_list_info);
+}
+
+} // namespace duckdb
@@ -0,0 +1,298 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Exact distinct count over hash digests.
+//
+// Instead of the values themselves, the aggregate stores their xxh3_64 or xxh3_128 digests (8 or 16 bytes per
+// distinct value) in linear-probing tables. The count is exact unless two distinct values share a digest; for n
+// distinct values that happens with probability about n^2 / 2^(bits + 1), i.e. ~3% for a billion values at 64 bits
+// and below 10^-20 at 128 bits.
+//
+// Digests are radix-partitioned on their top bits into independent tables, so merging thread-local states walks
+// one small partition at a time instead of probing a single large table at random. The merge itself is not
+// parallel: an aggregate combine receives one source and one target state and runs on the calling thread, with no
+// way to schedule tasks of its own. In grouped aggregations DuckDB combines different groups on different threads;
+// within one combine the partitions only improve locality.
+static constexpr idx_t DISTINCT_RADIX_BITS = 4;
+static constexpr idx_t DISTINCT_PARTITIONS = idx_t(1) << DISTINCT_RADIX_BITS;
+static constexpr idx_t DISTINCT_INITIAL_CAPACITY = 16;
+
+inline uint64_t DigestBits(const uint64_t digest) {
+	return digest;
+}
+
+inline uint64_t DigestBits(const uhugeint_t &digest) {
+	return digest.lower;
+}
+
+// Linear-probing set of non-zero digests; the all-zero digest is tracked by the owner
+template <class KEY>
+struct DigestPartition {
+	vector<KEY> slots;
+	idx_t count = 0;
+
+	void Insert(const KEY &key) {
+		if ((count + 1) * 4 > slots.size() * 3) {
+			Grow();
+		}
+		InsertNoGrow(key);
+	}
+
+	void InsertNoGrow(const KEY &key) {
+		const auto mask = slots.size() - 1;
+		for (auto i = DigestBits(key) & mask;; i = (i + 1) & mask) {
+			if (slots[i] == KEY(0)) {
+				slots[i] = key;
+				count++;
+				return;
+			}
+			if (slots[i] == key) {
+				return;
+			}
+		}
+	}
+
+	void Reserve(const idx_t expected) {
+		auto capacity = MaxValue<idx_t>(slots.size(), DISTINCT_INITIAL_CAPACITY);
+		while (expected * 4 > capacity * 3) {
+			capacity *= 2;
+		}
+		if (capacity != slots.size()) {
+			Rehash(capacity);
+		}
+	}
+
+	void Grow() {
+		Rehash(slots.empty() ? DISTINCT_INITIAL_CAPACITY : slots.size() * 2);
+	}
+
+	void Rehash(const idx_t capacity) {
+		vector<KEY> old_slots(capacity, KEY(0));
+		std::swap(slots, old_slots);
+		count = 0;
+		for (auto &key : old_slots) {
+			if (key != KEY(0)) {
+				InsertNoGrow(key);
+			}
+		}
+	}
+};
+
+template <class KEY>
+struct DigestSet {
+	DigestPartition<KEY> partitions[DISTINCT_PARTITIONS];
+	bool has_zero = false;
+
+	static inline idx_t PartitionIndex(const KEY &key) {
+		return DigestBits(key) >> (64 - DISTINCT_RADIX_BITS);
+	}
+
+	inline void Insert(const KEY &key) {
+		if (key == KEY(0)) {
+			has_zero = true;
+			return;
+		}
+		partitions[PartitionIndex(key)].Insert(key);
+	}
+
+	void Merge(const DigestSet &other) {
+		has_zero = has_zero || other.has_zero;
+		for (idx_t p = 0; p < DISTINCT_PARTITIONS; p++) {
+			auto &source = other.partitions[p];
+			if (source.count == 0) {
+				continue;
+			}
+			auto &target = partitions[p];
+			// Upper bound on the merged size, so the partition is resized at most once
+			target.Reserve(target.count + source.count);
+			for (auto &key : source.slots) {
+				if (key != KEY(0)) {
+					target.InsertNoGrow(key);
+				}
+			}
+		}
+	}
+
+	idx_t Count() const {
+		idx_t result = has_zero ? 1 : 0;
+		for (auto &partition : partitions) {
+			result += partition.count;
+		}
+		return result;
+	}
+};
+
+struct CountDistinctHashedBindData : public FunctionData {
+	explicit CountDistinctHashedBindData(idx_t bits_p) : bits(bits_p) {
+	}
+
+	idx_t bits;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<CountDistinctHashedBindData>(bits);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<CountDistinctHashedBindData>();
+		return bits == other.bits;
+	}
+};
+
+struct CountDistinctHashedState {
+	DigestSet<uint64_t> *set64;
+	DigestSet<uhugeint_t> *set128;
+};
+
+struct CountDistinctHashedOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.set64 = nullptr;
+		state.set128 = nullptr;
+	}
+
+	template <class KEY>
+	static void CombineSet(DigestSet<KEY> *source, DigestSet<KEY> *&target) {
+		if (!source) {
+			return;
+		}
+		if (!target) {
+			target = new DigestSet<KEY>(*source);
+			return;
+		}
+		target->Merge(*source);
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		CombineSet(source.set64, target.set64);
+		CombineSet(source.set128, target.set128);
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+		idx_t count = 0;
+		if (state.set64) {
+			count = state.set64->Count();
+		} else if (state.set128) {
+			count = state.set128->Count();
+		}
+		target = static_cast<T>(count);
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
+		if (state.set64) {
+			delete state.set64;
+			state.set64 = nullptr;
+		}
+		if (state.set128) {
+			delete state.set128;
+			state.set128 = nullptr;
+		}
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+template <class KEY, HashAlgorithm ALGORITHM>
+void CountDistinctHashedInsert(Vector &input, Vector &state_vector, idx_t count,
+                               DigestSet<KEY> *CountDistinctHashedState::*set_member) {
+	Vector hashes(std::is_same<KEY, uint64_t>::value ? LogicalType::UBIGINT : LogicalType::UHUGEINT, count);
+	hash_vector<KEY, ALGORITHM>(input, count, hashes);
+	auto hash_data = FlatVector::GetData<KEY>(hashes);
+	auto &hash_validity = FlatVector::Validity(hashes);
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<CountDistinctHashedState *>(sdata);
+
+	for (idx_t i = 0; i < count; i++) {
+		if (!hash_validity.RowIsValid(i)) {
+			continue;
+		}
+		auto &set = states[sdata.sel->get_index(i)]->*set_member;
+		if (!set) {
+			set = new DigestSet<KEY>();
+		}
+		set->Insert(hash_data[i]);
+	}
+}
+
+void CountDistinctHashedUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count,
+                               Vector &state_vector, idx_t count) {
+	auto &bind_data = aggr_input_data.bind_data->Cast<CountDistinctHashedBindData>();
+	if (bind_data.bits == 64) {
+		CountDistinctHashedInsert<uint64_t, HashAlgorithm::XXH3_64>(inputs[0], state_vector, count,
+		                                                            &CountDistinctHashedState::set64);
+	} else {
+		CountDistinctHashedInsert<uhugeint_t, HashAlgorithm::XXH3_128>(inputs[0], state_vector, count,
+		                                                               &CountDistinctHashedState::set128);
+	}
+}
+
+unique_ptr<FunctionData> CountDistinctHashedBind(ClientContext &context, AggregateFunction &function,
+                                                 vector<unique_ptr<Expression>> &arguments) {
+	if (!hash_vector_supports_type(arguments[0]->return_type)) {
+		throw BinderException("count_distinct_hashed: unsupported value type %s",
+		                      arguments[0]->return_type.ToString());
+	}
+	if (arguments.size() == 1) {
+		return make_uniq<CountDistinctHashedBindData>(128);
+	}
+	auto bits = GetConstantArgument(context, *arguments[1], "count_distinct_hashed", "bits").GetValue<int64_t>();
+	if (bits != 64 && bits != 128) {
+		throw BinderException("count_distinct_hashed: bits must be 64 or 128");
+	}
+	Function::EraseArgument(function, arguments, 1);
+	return make_uniq<CountDistinctHashedBindData>(static_cast<idx_t>(bits));
+}
+
+} // namespace
+
+void RegisterCountDistinctHashedFunctions(ExtensionLoader &loader) {
+	AggregateFunctionSet count_set("count_distinct_hashed");
+	for (auto &arguments : vector<vector<LogicalType>> {{LogicalType::ANY}, {LogicalType::ANY, LogicalType::INTEGER}}) {
+		AggregateFunction count_distinct(
+		    arguments, LogicalType::BIGINT, AggregateFunction::StateSize<CountDistinctHashedState>,
+		    AggregateFunction::StateInitialize<CountDistinctHashedState, CountDistinctHashedOperation>,
+		    CountDistinctHashedUpdate,
+		    AggregateFunction::StateCombine<CountDistinctHashedState, CountDistinctHashedOperation>,
+		    AggregateFunction::StateFinalize<CountDistinctHashedState, int64_t, CountDistinctHashedOperation>, nullptr,
+		    CountDistinctHashedBind,
+		    AggregateFunction::StateDestroy<CountDistinctHashedState, CountDistinctHashedOperation>);
+		count_distinct.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+		count_distinct.distinct_dependent = AggregateDistinctDependent::NOT_DISTINCT_DEPENDENT;
+		count_set.AddFunction(count_distinct);
+	}
+	CreateAggregateFunctionInfo count_info(count_set);
+	count_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY},
+	     /* parameter_names */ {"value"},
+	     /* description */
+	     "Counts distinct values by storing only their 128-bit xxh3_128 digests. Exact unless two distinct values "
+	     "collide, which for n values happens with probability about n^2 / 2^129",
+	     /* examples */ {"count_distinct_hashed(url)"},
+	     /* categories */ {"hash", "aggregate"}});
+	count_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::INTEGER},
+	     /* parameter_names */ {"value", "bits"},
+	     /* description */
+	     "Counts distinct values using 64-bit (xxh3_64) or 128-bit (xxh3_128) digests. 64-bit digests halve the "
+	     "memory; the collision probability for n values is about n^2 / 2^(bits + 1)",
+	     /* examples */ {"count_distinct_hashed(user_agent, 64)"},
+	     /* categories */ {"hash", "aggregate"}});
+	loader.RegisterFunction(count_info);
+}
+
+} // namespace duckdb
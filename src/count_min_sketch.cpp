@@ -0,0 +1,373 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Count-Min sketch with a cache-blocked counter layout.
+//
+// A textbook depth x width sketch touches `depth` unrelated cache lines per update. Here rows are paired and each
+// pair of rows owns an array of 16-counter blocks (128 bytes, an adjacent cache line pair): the first row of the
+// pair uses the first 8 counters of a block, the second row the last 8. For every pair a value derives one 64-bit
+// hash from its xxh3_64 hash (h + pair * golden ratio, remixed with fmix64); the top bits select the block and the
+// low bits the counter of each of the two rows. An update or estimate touches ceil(depth / 2) blocks instead of
+// `depth` cache lines.
+//
+// Every row still has `width` counters, so the expected overcount of each row is total / width as in the textbook
+// sketch. The two rows of a pair share their block, though: two values that collide in one row land in the same
+// block, and then collide in the other row with probability 1/8 instead of 1/width. Only the pairs are independent,
+// so the estimate exceeds the true count by more than e * total / width with probability at most e^-ceil(depth / 2)
+// rather than e^-depth.
+//
+// Serialized layout (little-endian):
+//   [0..3]   magic "CMS" + format version
+//   [4..7]   depth
+//   [8..11]  log2(number of blocks per row pair)
+//   [12..15] reserved (0)
+//   [16..23] total number of added values
+//   [24..]   counters, uint64 each, ordered by row pair, then block
+static constexpr idx_t CMS_BLOCK_COUNTERS = 16;
+static constexpr idx_t CMS_ROW_SLOTS = CMS_BLOCK_COUNTERS / 2;
+static constexpr idx_t CMS_HEADER_SIZE = 24;
+static constexpr uint8_t CMS_FORMAT_VERSION = 1;
+static constexpr idx_t CMS_MAX_DEPTH = 16;
+static constexpr idx_t CMS_MAX_WIDTH = idx_t(1) << 24;
+
+struct CountMinSketchShape {
+	uint32_t depth = 0;
+	uint32_t block_bits = 0;
+
+	static CountMinSketchShape FromWidthAndDepth(int64_t width, int64_t depth) {
+		if (depth < 1 || depth > static_cast<int64_t>(CMS_MAX_DEPTH)) {
+			throw BinderException("cms_build: depth must be between 1 and %d", CMS_MAX_DEPTH);
+		}
+		if (width < 1 || width > static_cast<int64_t>(CMS_MAX_WIDTH)) {
+			throw BinderException("cms_build: width must be between 1 and %d", CMS_MAX_WIDTH);
+		}
+		CountMinSketchShape shape;
+		shape.depth = static_cast<uint32_t>(depth);
+		// Round the number of blocks up to a power of two so the block is selected with a shift
+		const idx_t blocks_needed = (static_cast<idx_t>(width) + CMS_ROW_SLOTS - 1) / CMS_ROW_SLOTS;
+		while ((idx_t(1) << shape.block_bits) < blocks_needed) {
+			shape.block_bits++;
+		}
+		return shape;
+	}
+
+	inline idx_t RowPairs() const {
+		return (depth + 1) / 2;
+	}
+
+	inline idx_t CounterCount() const {
+		return RowPairs() * (idx_t(1) << block_bits) * CMS_BLOCK_COUNTERS;
+	}
+
+	inline idx_t SerializedSize() const {
+		return CMS_HEADER_SIZE + CounterCount() * sizeof(uint64_t);
+	}
+
+	bool operator==(const CountMinSketchShape &other) const {
+		return depth == other.depth && block_bits == other.block_bits;
+	}
+
+	// Compute the counter index of every row (depth indexes) for a value hash
+	inline void Locate(const uint64_t hash, idx_t *indexes) const {
+		for (uint32_t row = 0; row < depth; row += 2) {
+			const idx_t pair = row / 2;
+			const uint64_t derived = hash_fmix64(hash + pair * 0x9E3779B97F4A7C15ULL);
+			const idx_t block = block_bits == 0 ? 0 : static_cast<idx_t>(derived >> (64 - block_bits));
+			const idx_t base = ((pair << block_bits) + block) * CMS_BLOCK_COUNTERS;
+			indexes[row] = base + (derived & (CMS_ROW_SLOTS - 1));
+			if (row + 1 < depth) {
+				indexes[row + 1] = base + CMS_ROW_SLOTS + ((derived >> 3) & (CMS_ROW_SLOTS - 1));
+			}
+		}
+	}
+};
+
+struct CountMinSketch {
+	explicit CountMinSketch(const CountMinSketchShape &shape_p)
+	    : shape(shape_p), total(0), counters(shape_p.CounterCount(), 0) {
+	}
+
+	CountMinSketchShape shape;
+	uint64_t total;
+	vector<uint64_t> counters;
+
+	inline void Add(const uint64_t hash) {
+		idx_t indexes[CMS_MAX_DEPTH];
+		shape.Locate(hash, indexes);
+		for (uint32_t row = 0; row < shape.depth; row++) {
+			counters[indexes[row]]++;
+		}
+		total++;
+	}
+
+	void Merge(const CountMinSketch &other) {
+		D_ASSERT(shape == other.shape);
+		for (idx_t i = 0; i < counters.size(); i++) {
+			counters[i] += other.counters[i];
+		}
+		total += other.total;
+	}
+
+	static void SerializeEmpty(const CountMinSketchShape &shape, data_ptr_t ptr) {
+		ptr[0] = 'C';
+		ptr[1] = 'M';
+		ptr[2] = 'S';
+		ptr[3] = CMS_FORMAT_VERSION;
+		Store<uint32_t>(shape.depth, ptr + 4);
+		Store<uint32_t>(shape.block_bits, ptr + 8);
+		Store<uint32_t>(0, ptr + 12);
+		Store<uint64_t>(0, ptr + 16);
+		memset(ptr + CMS_HEADER_SIZE, 0, shape.CounterCount() * sizeof(uint64_t));
+	}
+
+	void Serialize(data_ptr_t ptr) const {
+		SerializeEmpty(shape, ptr);
+		Store<uint64_t>(total, ptr + 16);
+		memcpy(ptr + CMS_HEADER_SIZE, counters.data(), counters.size() * sizeof(uint64_t));
+	}
+};
+
+// Read-only view over a serialized sketch; estimates read the counters in place without copying the BLOB
+struct CountMinSketchView {
+	CountMinSketchShape shape;
+	const_data_ptr_t counters = nullptr;
+
+	static CountMinSketchView Parse(const string_t &blob) {
+		const auto size = blob.GetSize();
+		const auto ptr = const_data_ptr_cast(blob.GetData());
+		if (size < CMS_HEADER_SIZE || ptr[0] != 'C' || ptr[1] != 'M' || ptr[2] != 'S') {
+			throw InvalidInputException("cms_estimate: input is not a Count-Min sketch produced by cms_build");
+		}
+		if (ptr[3] != CMS_FORMAT_VERSION) {
+			throw InvalidInputException("cms_estimate: unsupported Count-Min sketch format version %d",
+			                            static_cast<int64_t>(ptr[3]));
+		}
+		CountMinSketchView view;
+		view.shape.depth = Load<uint32_t>(ptr + 4);
+		view.shape.block_bits = Load<uint32_t>(ptr + 8);
+		if (view.shape.depth < 1 || view.shape.depth > CMS_MAX_DEPTH || view.shape.block_bits > 32 ||
+		    size != view.shape.SerializedSize()) {
+			throw InvalidInputException("cms_estimate: Count-Min sketch is corrupt or truncated");
+		}
+		view.counters = ptr + CMS_HEADER_SIZE;
+		return view;
+	}
+
+	inline uint64_t Estimate(const uint64_t hash) const {
+		idx_t indexes[CMS_MAX_DEPTH];
+		shape.Locate(hash, indexes);
+		uint64_t estimate = NumericLimits<uint64_t>::Maximum();
+		for (uint32_t row = 0; row < shape.depth; row++) {
+			estimate = MinValue(estimate, Load<uint64_t>(counters + indexes[row] * sizeof(uint64_t)));
+		}
+		return estimate;
+	}
+};
+
+struct CountMinSketchBindData : public FunctionData {
+	explicit CountMinSketchBindData(const CountMinSketchShape &shape_p) : shape(shape_p) {
+	}
+
+	CountMinSketchShape shape;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<CountMinSketchBindData>(shape);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<CountMinSketchBindData>();
+		return shape == other.shape;
+	}
+};
+
+struct CountMinSketchState {
+	CountMinSketch *sketch;
+};
+
+struct CountMinSketchOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.sketch = nullptr;
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		if (!source.sketch) {
+			return;
+		}
+		if (!target.sketch) {
+			target.sketch = new CountMinSketch(*source.sketch);
+			return;
+		}
+		target.sketch->Merge(*source.sketch);
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+		auto &bind_data = finalize_data.input.bind_data->Cast<CountMinSketchBindData>();
+		auto blob = StringVector::EmptyString(finalize_data.result, bind_data.shape.SerializedSize());
+		auto ptr = data_ptr_cast(blob.GetDataWriteable());
+		if (state.sketch) {
+			state.sketch->Serialize(ptr);
+		} else {
+			// An empty group still produces a valid (all-zero) sketch so estimates against it return 0
+			CountMinSketch::SerializeEmpty(bind_data.shape, ptr);
+		}
+		blob.Finalize();
+		target = blob;
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
+		if (state.sketch) {
+			delete state.sketch;
+			state.sketch = nullptr;
+		}
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+void CountMinSketchUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count,
+                          Vector &state_vector, idx_t count) {
+	auto &bind_data = aggr_input_data.bind_data->Cast<CountMinSketchBindData>();
+
+	// Hash the whole chunk with the same kernel as xxh3_64() before touching any state
+	Vector hashes(LogicalType::UBIGINT, count);
+	hash_vector<uint64_t, HashAlgorithm::XXH3_64>(inputs[0], count, hashes);
+	auto hash_data = FlatVector::GetData<uint64_t>(hashes);
+	auto &hash_validity = FlatVector::Validity(hashes);
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<CountMinSketchState *>(sdata);
+
+	for (idx_t i = 0; i < count; i++) {
+		if (!hash_validity.RowIsValid(i)) {
+			continue;
+		}
+		auto &state = *states[sdata.sel->get_index(i)];
+		if (!state.sketch) {
+			state.sketch = new CountMinSketch(bind_data.shape);
+		}
+		state.sketch->Add(hash_data[i]);
+	}
+}
+
+unique_ptr<FunctionData> CountMinSketchBind(ClientContext &context, AggregateFunction &function,
+                                            vector<unique_ptr<Expression>> &arguments) {
+	auto &value_type = arguments[0]->return_type;
+	if (!hash_vector_supports_type(value_type)) {
+		throw BinderException("cms_build: unsupported value type %s", value_type.ToString());
+	}
+	auto width = GetConstantArgument(context, *arguments[1], "cms_build", "width").GetValue<int64_t>();
+	auto depth = GetConstantArgument(context, *arguments[2], "cms_build", "depth").GetValue<int64_t>();
+	auto shape = CountMinSketchShape::FromWidthAndDepth(width, depth);
+
+	// The sizes are baked into the bind data, so the executor only has to feed the hashed values
+	Function::EraseArgument(function, arguments, 2);
+	Function::EraseArgument(function, arguments, 1);
+	return make_uniq<CountMinSketchBindData>(shape);
+}
+
+inline void CountMinSketchEstimateFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &sketch_vector = args.data[0];
+	auto &value_vector = args.data[1];
+	const auto row_count = args.size();
+
+	if (row_count == 0) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+		return;
+	}
+
+	Vector hashes(LogicalType::UBIGINT, row_count);
+	hash_vector<uint64_t, HashAlgorithm::XXH3_64>(value_vector, row_count, hashes);
+	auto hash_data = FlatVector::GetData<uint64_t>(hashes);
+	auto &hash_validity = FlatVector::Validity(hashes);
+
+	UnifiedVectorFormat sketch_vdata;
+	sketch_vector.ToUnifiedFormat(row_count, sketch_vdata);
+	auto sketches = UnifiedVectorFormat::GetData<string_t>(sketch_vdata);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto &result_validity = FlatVector::Validity(result);
+	auto results = FlatVector::GetData<uint64_t>(result);
+
+	// The sketch is almost always a constant or a scalar subquery, so only re-parse the header when it changes
+	const char *parsed_ptr = nullptr;
+	CountMinSketchView view;
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto sketch_idx = sketch_vdata.sel->get_index(i);
+		if (!sketch_vdata.validity.RowIsValid(sketch_idx) || !hash_validity.RowIsValid(i)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		const auto &blob = sketches[sketch_idx];
+		if (blob.GetData() != parsed_ptr) {
+			view = CountMinSketchView::Parse(blob);
+			parsed_ptr = blob.GetData();
+		}
+		results[i] = view.Estimate(hash_data[i]);
+	}
+
+	// Optimize for single-row results
+	if (row_count == 1) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+} // namespace
+
+void RegisterCountMinSketchFunctions(ExtensionLoader &loader) {
+	AggregateFunctionSet cms_build_set("cms_build");
+	AggregateFunction cms_build({LogicalType::ANY, LogicalType::INTEGER, LogicalType::INTEGER}, LogicalType::BLOB,
+	                            AggregateFunction::StateSize<CountMinSketchState>,
+	                            AggregateFunction::StateInitialize<CountMinSketchState, CountMinSketchOperation>,
+	                            CountMinSketchUpdate,
+	                            AggregateFunction::StateCombine<CountMinSketchState, CountMinSketchOperation>,
+	                            AggregateFunction::StateFinalize<CountMinSketchState, string_t, CountMinSketchOperation>,
+	                            nullptr, CountMinSketchBind,
+	                            AggregateFunction::StateDestroy<CountMinSketchState, CountMinSketchOperation>);
+	cms_build.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+	cms_build_set.AddFunction(cms_build);
+	CreateAggregateFunctionInfo cms_build_info(cms_build_set);
+	cms_build_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::INTEGER, LogicalType::INTEGER},
+	     /* parameter_names */ {"value", "width", "depth"},
+	     /* description */
+	     "Builds a Count-Min sketch of the xxh3_64 hashes of the input with at least `width` counters per row and "
+	     "`depth` rows (1-16), stored in pairs of rows that share a cache line block. The sketch is returned as a "
+	     "BLOB that can be probed with cms_estimate",
+	     /* examples */ {"cms_build(user_id, 2048, 4)"},
+	     /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(cms_build_info);
+
+	ScalarFunctionSet cms_estimate_set("cms_estimate");
+	cms_estimate_set.AddFunction(ScalarFunction({LogicalType::BLOB, LogicalType::ANY}, LogicalType::UBIGINT,
+	                                            CountMinSketchEstimateFunction));
+	CreateScalarFunctionInfo cms_estimate_info(cms_estimate_set);
+	cms_estimate_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::ANY},
+	     /* parameter_names */ {"sketch", "value"},
+	     /* description */
+	     "Estimates how often a value was added to a Count-Min sketch built by cms_build. The estimate never "
+	     "undercounts, and overcounts by more than e * total / width with probability at most e^-ceil(depth / 2)",
+	     /* examples */ {"cms_estimate((SELECT cms_build(user_id, 2048, 4) FROM events), 42)"},
+	     /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(cms_estimate_info);
+}
+
+} // namespace duckdb
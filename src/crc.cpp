@@ -0,0 +1,331 @@
+#include "crc.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HASHFUNCS_CRC_X86_64 1
+#include <immintrin.h>
+#endif
+
+namespace duckdb {
+
+namespace {
+
+// Table-driven CRCs (slicing-by-8) for every platform, plus x86-64 kernels used when the CPU supports them:
+//
+// - CRC-32C uses the SSE4.2 crc32 instruction. Long inputs are split into three blocks hashed in interleaved
+//   streams, which hides the instruction's 3-cycle latency; the three CRCs are then merged by shifting with one
+//   carry-less multiplication each.
+// - CRC-32 and CRC-64 fold the input with PCLMULQDQ, four 128-bit lanes at a time, down to a 16-byte remainder that
+//   is finished with the tables. The folding constants are x^n mod P for the lane distances and are derived from the
+//   polynomial at startup rather than hard-coded.
+//
+// All three CRCs are reflected with an initial value and final xor of all ones. Internally the kernels work on the
+// raw register (no initial value or final xor); the public functions apply both.
+constexpr uint32_t CRC32_POLY = 0xEDB88320U;
+constexpr uint32_t CRC32C_POLY = 0x82F63B78U;
+constexpr uint64_t CRC64_POLY = 0xC96C5795D7870F42ULL;
+
+// Inputs shorter than this are not worth setting up the PCLMULQDQ lanes for
+constexpr size_t CRC_FOLD_MIN_LENGTH = 128;
+// Block sizes of the interleaved CRC-32C streams
+constexpr size_t CRC32C_LONG_BLOCK = 8192;
+constexpr size_t CRC32C_SHORT_BLOCK = 256;
+
+template <class T>
+struct CRCTables {
+	// table[k][n] is the CRC register after byte n followed by k zero bytes
+	T table[8][256];
+};
+
+template <class T, T POLY>
+constexpr CRCTables<T> MakeCRCTables() {
+	CRCTables<T> tables {};
+	for (unsigned n = 0; n < 256; n++) {
+		T crc = static_cast<T>(n);
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc & 1) ? static_cast<T>((crc >> 1) ^ POLY) : static_cast<T>(crc >> 1);
+		}
+		tables.table[0][n] = crc;
+	}
+	for (unsigned n = 0; n < 256; n++) {
+		for (int k = 1; k < 8; k++) {
+			const T previous = tables.table[k - 1][n];
+			tables.table[k][n] = static_cast<T>((previous >> 8) ^ tables.table[0][previous & 0xff]);
+		}
+	}
+	return tables;
+}
+
+constexpr CRCTables<uint32_t> CRC32_TABLES = MakeCRCTables<uint32_t, CRC32_POLY>();
+constexpr CRCTables<uint32_t> CRC32C_TABLES = MakeCRCTables<uint32_t, CRC32C_POLY>();
+constexpr CRCTables<uint64_t> CRC64_TABLES = MakeCRCTables<uint64_t, CRC64_POLY>();
+
+template <class T>
+T CRCTableUpdate(const CRCTables<T> &tables, T crc, const uint8_t *data, size_t len) {
+	const auto &t = tables.table;
+	while (len >= 8) {
+		uint64_t word;
+		memcpy(&word, data, sizeof(word));
+		word ^= crc;
+		crc = static_cast<T>(t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^
+		                     t[4][(word >> 24) & 0xff] ^ t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^
+		                     t[1][(word >> 48) & 0xff] ^ t[0][word >> 56]);
+		data += 8;
+		len -= 8;
+	}
+	while (len--) {
+		crc = static_cast<T>((crc >> 8) ^ t[0][(crc ^ *data++) & 0xff]);
+	}
+	return crc;
+}
+
+// a * b mod P in the reflected representation, where the top bit is x^0. a must be non-zero.
+template <class T, T POLY>
+T CRCMultModP(T a, T b) {
+	T m = T(1) << (sizeof(T) * 8 - 1);
+	T product = 0;
+	for (;;) {
+		if (a & m) {
+			product ^= b;
+			if ((a & (m - 1)) == 0) {
+				break;
+			}
+		}
+		m >>= 1;
+		b = (b & 1) ? static_cast<T>((b >> 1) ^ POLY) : static_cast<T>(b >> 1);
+	}
+	return product;
+}
+
+// x^(8 * len) mod P, by squaring: powers[k] is x^(2^k) mod P
+template <class T, T POLY>
+T CRCBytePowerModP(uint64_t len) {
+	struct Powers {
+		T power[64];
+		Powers() {
+			power[0] = T(1) << (sizeof(T) * 8 - 2);
+			for (int k = 1; k < 64; k++) {
+				power[k] = CRCMultModP<T, POLY>(power[k - 1], power[k - 1]);
+			}
+		}
+	};
+	static const Powers powers;
+	T result = T(1) << (sizeof(T) * 8 - 1);
+	for (int k = 3; len; len >>= 1, k++) {
+		if (len & 1) {
+			result = CRCMultModP<T, POLY>(powers.power[k], result);
+		}
+	}
+	return result;
+}
+
+template <class T, T POLY>
+T CRCCombine(T crc_a, T crc_b, uint64_t len_b) {
+	// The all-ones initial value and final xor cancel out, so only crc_a has to be shifted past b
+	return CRCMultModP<T, POLY>(CRCBytePowerModP<T, POLY>(len_b), crc_a) ^ crc_b;
+}
+
+#ifdef HASHFUNCS_CRC_X86_64
+
+// x^n mod P for a reflected polynomial of WIDTH bits, returned bit-reversed in 64 bits (x^0 in the top bit) as
+// PCLMULQDQ operands expect
+template <class T, T POLY>
+uint64_t CRCReflectedPowerModP(uint64_t n) {
+	constexpr int WIDTH = sizeof(T) * 8;
+	// Multiplying by x in the reflected representation is a right shift
+	T value = T(1) << (WIDTH - 1);
+	for (uint64_t i = 0; i < n; i++) {
+		value = (value & 1) ? static_cast<T>((value >> 1) ^ POLY) : static_cast<T>(value >> 1);
+	}
+	return static_cast<uint64_t>(value) << (64 - WIDTH);
+}
+
+struct CRCFoldConstants {
+	__m128i fold_by_4;
+	__m128i fold_by_1;
+};
+
+// Carry-less multiplication of reflected operands yields the product times x, so folding a 128-bit lane forward
+// by D bits multiplies its high part (the lower register half) by x^(D+63) and its low part by x^(D-1)
+template <class T, T POLY>
+CRCFoldConstants MakeCRCFoldConstants() {
+	CRCFoldConstants constants;
+	constants.fold_by_4 = _mm_set_epi64x(static_cast<int64_t>(CRCReflectedPowerModP<T, POLY>(512 - 1)),
+	                                     static_cast<int64_t>(CRCReflectedPowerModP<T, POLY>(512 + 63)));
+	constants.fold_by_1 = _mm_set_epi64x(static_cast<int64_t>(CRCReflectedPowerModP<T, POLY>(128 - 1)),
+	                                     static_cast<int64_t>(CRCReflectedPowerModP<T, POLY>(128 + 63)));
+	return constants;
+}
+
+__attribute__((target("sse4.2,pclmul"))) inline __m128i CRCFold(const __m128i lane, const __m128i constants) {
+	return _mm_xor_si128(_mm_clmulepi64_si128(lane, constants, 0x00), _mm_clmulepi64_si128(lane, constants, 0x11));
+}
+
+template <class T>
+__attribute__((target("sse4.2,pclmul"))) T CRCFoldUpdate(const CRCTables<T> &tables, const CRCFoldConstants &constants,
+                                                         T crc, const uint8_t *data, size_t len) {
+	auto load = [](const uint8_t *ptr) {
+		return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+	};
+	// The register is xored into the first bytes of the message, then only the message is folded
+	__m128i x0 = _mm_xor_si128(load(data), _mm_cvtsi64_si128(static_cast<int64_t>(crc)));
+	__m128i x1 = load(data + 16);
+	__m128i x2 = load(data + 32);
+	__m128i x3 = load(data + 48);
+	data += 64;
+	len -= 64;
+	while (len >= 64) {
+		x0 = _mm_xor_si128(CRCFold(x0, constants.fold_by_4), load(data));
+		x1 = _mm_xor_si128(CRCFold(x1, constants.fold_by_4), load(data + 16));
+		x2 = _mm_xor_si128(CRCFold(x2, constants.fold_by_4), load(data + 32));
+		x3 = _mm_xor_si128(CRCFold(x3, constants.fold_by_4), load(data + 48));
+		data += 64;
+		len -= 64;
+	}
+	x1 = _mm_xor_si128(CRCFold(x0, constants.fold_by_1), x1);
+	x2 = _mm_xor_si128(CRCFold(x1, constants.fold_by_1), x2);
+	x0 = _mm_xor_si128(CRCFold(x2, constants.fold_by_1), x3);
+	while (len >= 16) {
+		x0 = _mm_xor_si128(CRCFold(x0, constants.fold_by_1), load(data));
+		data += 16;
+		len -= 16;
+	}
+	// The remaining lane is congruent to everything folded so far; its CRC from a zero register continues the message
+	uint8_t remainder[16];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(remainder), x0);
+	crc = CRCTableUpdate<T>(tables, 0, remainder, sizeof(remainder));
+	return CRCTableUpdate<T>(tables, crc, data, len);
+}
+
+// Shifts a CRC-32C register past len zero bytes, given reflected x^(8 * len - 33) mod P
+__attribute__((target("sse4.2,pclmul"))) inline uint32_t CRC32CShift(const uint32_t crc, const uint32_t constant) {
+	const auto product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crc)),
+	                                          _mm_cvtsi32_si128(static_cast<int>(constant)), 0x00);
+	return static_cast<uint32_t>(_mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(product))));
+}
+
+template <size_t BLOCK>
+__attribute__((target("sse4.2,pclmul"))) inline uint64_t CRC32CInterleaved(uint64_t crc, const uint8_t *&data,
+                                                                             size_t &len, const uint32_t shift) {
+	while (len >= 3 * BLOCK) {
+		uint64_t crc1 = 0;
+		uint64_t crc2 = 0;
+		for (size_t offset = 0; offset < BLOCK; offset += 8) {
+			uint64_t word0, word1, word2;
+			memcpy(&word0, data + offset, sizeof(uint64_t));
+			memcpy(&word1, data + BLOCK + offset, sizeof(uint64_t));
+			memcpy(&word2, data + 2 * BLOCK + offset, sizeof(uint64_t));
+			crc = _mm_crc32_u64(crc, word0);
+			crc1 = _mm_crc32_u64(crc1, word1);
+			crc2 = _mm_crc32_u64(crc2, word2);
+		}
+		crc = CRC32CShift(static_cast<uint32_t>(crc), shift) ^ crc1;
+		crc = CRC32CShift(static_cast<uint32_t>(crc), shift) ^ crc2;
+		data += 3 * BLOCK;
+		len -= 3 * BLOCK;
+	}
+	return crc;
+}
+
+__attribute__((target("sse4.2,pclmul"))) uint32_t CRC32CHardwareUpdate(uint32_t crc_p, const uint8_t *data,
+                                                                        size_t len) {
+	static const uint32_t long_shift =
+	    static_cast<uint32_t>(CRCReflectedPowerModP<uint32_t, CRC32C_POLY>(8 * CRC32C_LONG_BLOCK - 33) >> 32);
+	static const uint32_t short_shift =
+	    static_cast<uint32_t>(CRCReflectedPowerModP<uint32_t, CRC32C_POLY>(8 * CRC32C_SHORT_BLOCK - 33) >> 32);
+	uint64_t crc = crc_p;
+	crc = CRC32CInterleaved<CRC32C_LONG_BLOCK>(crc, data, len, long_shift);
+	crc = CRC32CInterleaved<CRC32C_SHORT_BLOCK>(crc, data, len, short_shift);
+	while (len >= 8) {
+		uint64_t word;
+		memcpy(&word, data, sizeof(word));
+		crc = _mm_crc32_u64(crc, word);
+		data += 8;
+		len -= 8;
+	}
+	auto crc32 = static_cast<uint32_t>(crc);
+	while (len--) {
+		crc32 = _mm_crc32_u8(crc32, *data++);
+	}
+	return crc32;
+}
+
+struct CRCHardwareSupport {
+	bool sse42;
+	bool pclmul;
+	CRCFoldConstants crc32_fold;
+	CRCFoldConstants crc64_fold;
+
+	CRCHardwareSupport() {
+		__builtin_cpu_init();
+		sse42 = __builtin_cpu_supports("sse4.2");
+		pclmul = sse42 && __builtin_cpu_supports("pclmul");
+		crc32_fold = MakeCRCFoldConstants<uint32_t, CRC32_POLY>();
+		crc64_fold = MakeCRCFoldConstants<uint64_t, CRC64_POLY>();
+	}
+};
+
+const CRCHardwareSupport &GetCRCHardwareSupport() {
+	static const CRCHardwareSupport support;
+	return support;
+}
+
+#endif
+
+uint32_t CRC32Register(uint32_t crc, const uint8_t *data, size_t len) {
+#ifdef HASHFUNCS_CRC_X86_64
+	auto &support = GetCRCHardwareSupport();
+	if (support.pclmul && len >= CRC_FOLD_MIN_LENGTH) {
+		return CRCFoldUpdate<uint32_t>(CRC32_TABLES, support.crc32_fold, crc, data, len);
+	}
+#endif
+	return CRCTableUpdate<uint32_t>(CRC32_TABLES, crc, data, len);
+}
+
+uint32_t CRC32CRegister(uint32_t crc, const uint8_t *data, size_t len) {
+#ifdef HASHFUNCS_CRC_X86_64
+	if (GetCRCHardwareSupport().pclmul) {
+		return CRC32CHardwareUpdate(crc, data, len);
+	}
+#endif
+	return CRCTableUpdate<uint32_t>(CRC32C_TABLES, crc, data, len);
+}
+
+uint64_t CRC64Register(uint64_t crc, const uint8_t *data, size_t len) {
+#ifdef HASHFUNCS_CRC_X86_64
+	auto &support = GetCRCHardwareSupport();
+	if (support.pclmul && len >= CRC_FOLD_MIN_LENGTH) {
+		return CRCFoldUpdate<uint64_t>(CRC64_TABLES, support.crc64_fold, crc, data, len);
+	}
+#endif
+	return CRCTableUpdate<uint64_t>(CRC64_TABLES, crc, data, len);
+}
+
+} // namespace
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len) {
+	return ~CRC32Register(~crc, static_cast<const uint8_t *>(data), len);
+}
+
+uint32_t crc32c_update(uint32_t crc, const void *data, size_t len) {
+	return ~CRC32CRegister(~crc, static_cast<const uint8_t *>(data), len);
+}
+
+uint64_t crc64_update(uint64_t crc, const void *data, size_t len) {
+	return ~CRC64Register(~crc, static_cast<const uint8_t *>(data), len);
+}
+
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b) {
+	return CRCCombine<uint32_t, CRC32_POLY>(crc_a, crc_b, len_b);
+}
+
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b) {
+	return CRCCombine<uint32_t, CRC32C_POLY>(crc_a, crc_b, len_b);
+}
+
+uint64_t crc64_combine(uint64_t crc_a, uint64_t crc_b, uint64_t len_b) {
+	return CRCCombine<uint64_t, CRC64_POLY>(crc_a, crc_b, len_b);
+}
+
+} // namespace duckdb
@@ -0,0 +1,175 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "crc.hpp"
+#include "hashfuncs_functions.hpp"
+
+#include <algorithm>
+
+namespace duckdb {
+
+namespace {
+
+// CRC combination and parallel CRCs of ordered concatenations.
+//
+// crc32_concat(piece, position) returns the CRC of all pieces concatenated in position order. Every piece is
+// checksummed where it is scanned, on any thread and in any order; the state only keeps (position, crc, length) per
+// piece. Finalize sorts the pieces and joins their CRCs with crc32_combine, which costs O(log length) per piece
+// independent of the piece size. This is how the CRC of a large object stored as ordered chunks is verified without
+// reassembling it or scanning it on one thread.
+template <class T>
+struct CRCPiece {
+	int64_t position;
+	T crc;
+	uint64_t length;
+};
+
+template <class T>
+struct CRCConcatState {
+	vector<CRCPiece<T>> *pieces;
+};
+
+template <class T, T (*UPDATE)(T, const void *, size_t), T (*COMBINE)(T, T, uint64_t)>
+struct CRCConcatOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.pieces = nullptr;
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		if (!source.pieces) {
+			return;
+		}
+		if (!target.pieces) {
+			target.pieces = new vector<CRCPiece<T>>(*source.pieces);
+			return;
+		}
+		target.pieces->insert(target.pieces->end(), source.pieces->begin(), source.pieces->end());
+	}
+
+	template <class RESULT_TYPE, class STATE>
+	static void Finalize(STATE &state, RESULT_TYPE &target, AggregateFinalizeData &finalize_data) {
+		if (!state.pieces || state.pieces->empty()) {
+			finalize_data.ReturnNull();
+			return;
+		}
+		auto &pieces = *state.pieces;
+		std::sort(pieces.begin(), pieces.end(),
+		          [](const CRCPiece<T> &a, const CRCPiece<T> &b) { return a.position < b.position; });
+		T crc = pieces[0].crc;
+		for (idx_t i = 1; i < pieces.size(); i++) {
+			crc = COMBINE(crc, pieces[i].crc, pieces[i].length);
+		}
+		target = crc;
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
+		if (state.pieces) {
+			delete state.pieces;
+			state.pieces = nullptr;
+		}
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+
+	static void Update(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vector,
+	                   idx_t count) {
+		UnifiedVectorFormat data_vdata, position_vdata, sdata;
+		inputs[0].ToUnifiedFormat(count, data_vdata);
+		inputs[1].ToUnifiedFormat(count, position_vdata);
+		state_vector.ToUnifiedFormat(count, sdata);
+		auto data = UnifiedVectorFormat::GetData<string_t>(data_vdata);
+		auto positions = UnifiedVectorFormat::GetData<int64_t>(position_vdata);
+		auto states = UnifiedVectorFormat::GetData<CRCConcatState<T> *>(sdata);
+
+		for (idx_t i = 0; i < count; i++) {
+			const auto data_idx = data_vdata.sel->get_index(i);
+			const auto position_idx = position_vdata.sel->get_index(i);
+			if (!data_vdata.validity.RowIsValid(data_idx) || !position_vdata.validity.RowIsValid(position_idx)) {
+				continue;
+			}
+			auto &state = *states[sdata.sel->get_index(i)];
+			if (!state.pieces) {
+				state.pieces = new vector<CRCPiece<T>>();
+			}
+			const auto &piece = data[data_idx];
+			state.pieces->push_back(
+			    {positions[position_idx], UPDATE(0, piece.GetData(), piece.GetSize()), piece.GetSize()});
+		}
+	}
+};
+
+template <class T, T (*UPDATE)(T, const void *, size_t), T (*COMBINE)(T, T, uint64_t)>
+void RegisterCRCConcat(ExtensionLoader &loader, const string &name, const LogicalType &result_type,
+                       const string &crc_name) {
+	using STATE = CRCConcatState<T>;
+	using OP = CRCConcatOperation<T, UPDATE, COMBINE>;
+	AggregateFunctionSet concat_set(name);
+	for (auto &data_type : {LogicalType::BLOB, LogicalType::VARCHAR}) {
+		AggregateFunction concat({data_type, LogicalType::BIGINT}, result_type, AggregateFunction::StateSize<STATE>,
+		                         AggregateFunction::StateInitialize<STATE, OP>, OP::Update,
+		                         AggregateFunction::StateCombine<STATE, OP>,
+		                         AggregateFunction::StateFinalize<STATE, T, OP>, nullptr, nullptr,
+		                         AggregateFunction::StateDestroy<STATE, OP>);
+		concat.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+		concat_set.AddFunction(concat);
+	}
+	CreateAggregateFunctionInfo concat_info(concat_set);
+	concat_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::BIGINT},
+	     /* parameter_names */ {"piece", "position"},
+	     /* description */
+	     "Computes the " + crc_name + " of all pieces concatenated in position order. Pieces are checksummed in "
+	     "parallel and joined with " + crc_name + " combination, so row order does not matter",
+	     /* examples */ {name + "(chunk, chunk_index)"},
+	     /* categories */ {"hash", "aggregate"}});
+	loader.RegisterFunction(concat_info);
+}
+
+template <class T, T (*COMBINE)(T, T, uint64_t)>
+void CRCCombineFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	TernaryExecutor::Execute<T, T, uint64_t, T>(args.data[0], args.data[1], args.data[2], result, args.size(),
+	                                            [](const T crc_a, const T crc_b, const uint64_t len_b) {
+		                                            return COMBINE(crc_a, crc_b, len_b);
+	                                            });
+}
+
+template <class T, T (*COMBINE)(T, T, uint64_t)>
+void RegisterCRCCombine(ExtensionLoader &loader, const string &name, const LogicalType &crc_type,
+                        const string &crc_name) {
+	ScalarFunctionSet combine_set(name);
+	combine_set.AddFunction(ScalarFunction({crc_type, crc_type, LogicalType::UBIGINT}, crc_type,
+	                                       CRCCombineFunction<T, COMBINE>));
+	CreateScalarFunctionInfo combine_info(combine_set);
+	combine_info.descriptions.push_back(
+	    {/* parameter_types */ {crc_type, crc_type, LogicalType::UBIGINT},
+	     /* parameter_names */ {"crc_a", "crc_b", "length_b"},
+	     /* description */
+	     "Returns the " + crc_name + " of a followed by b, given the " + crc_name +
+	         " of a, the one of b and the length of b in bytes",
+	     /* examples */ {name + "(crc_a, crc_b, octet_length(b))"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(combine_info);
+}
+
+} // namespace
+
+void RegisterCRCFunctions(ExtensionLoader &loader) {
+	RegisterCRCCombine<uint32_t, crc32_combine>(loader, "crc32_combine", LogicalType::UINTEGER, "CRC-32");
+	RegisterCRCCombine<uint32_t, crc32c_combine>(loader, "crc32c_combine", LogicalType::UINTEGER, "CRC-32C");
+	RegisterCRCCombine<uint64_t, crc64_combine>(loader, "crc64_combine", LogicalType::UBIGINT, "CRC-64");
+
+	RegisterCRCConcat<uint32_t, crc32_update, crc32_combine>(loader, "crc32_concat", LogicalType::UINTEGER, "CRC-32");
+	RegisterCRCConcat<uint32_t, crc32c_update, crc32c_combine>(loader, "crc32c_concat", LogicalType::UINTEGER,
+	                                                           "CRC-32C");
+	RegisterCRCConcat<uint64_t, crc64_update, crc64_combine>(loader, "crc64_concat", LogicalType::UBIGINT, "CRC-64");
+}
+
+} // namespace duckdb
@@ -0,0 +1,210 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Hash bucketing.
+//
+// hash_bucket(value, n) = floor(h * n / 2^64) for the 64-bit hash h of the value, i.e. Lemire's multiply-high range
+// reduction instead of h % n. It costs one multiplication per row instead of a 64-bit division, and every bucket
+// receives an equal share of the hash space (within one hash value).
+//
+// jump_hash(value, n) maps h with jump consistent hashing instead, so growing n to n + 1 moves only 1/(n + 1) of the
+// keys. A UBIGINT value passed without algo is taken to be a precomputed hash and used as is.
+//
+// Both write the digests straight into the result vector and reduce them in place. When n is a constant it is taken
+// from bind data, and chunks without NULLs are reduced in a loop without validity checks.
+static constexpr int64_t JUMP_HASH_MAX_BUCKETS = NumericLimits<int32_t>::Maximum();
+
+struct HashBucketBindData : public FunctionData {
+	HashBucketBindData(const HashAlgorithm algorithm_p, const bool hash_input_p, const uint64_t bucket_count_p)
+	    : algorithm(algorithm_p), hash_input(hash_input_p), bucket_count(bucket_count_p) {
+	}
+
+	HashAlgorithm algorithm;
+	//! Whether the input is hashed, or already is a 64-bit hash
+	bool hash_input;
+	//! The constant bucket count, or 0 when it varies per row
+	uint64_t bucket_count;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<HashBucketBindData>(algorithm, hash_input, bucket_count);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<HashBucketBindData>();
+		return algorithm == other.algorithm && hash_input == other.hash_input && bucket_count == other.bucket_count;
+	}
+};
+
+struct MultiplyHighBucket {
+	static constexpr const char *NAME = "hash_bucket";
+	static constexpr bool ACCEPTS_HASH = false;
+	static constexpr int64_t MAX_BUCKETS = NumericLimits<int64_t>::Maximum();
+
+	static inline uint64_t Bucket(const uint64_t hash, const uint64_t n) {
+		return hash_reduce_range(hash, n);
+	}
+};
+
+struct JumpBucket {
+	static constexpr const char *NAME = "jump_hash";
+	static constexpr bool ACCEPTS_HASH = true;
+	static constexpr int64_t MAX_BUCKETS = JUMP_HASH_MAX_BUCKETS;
+
+	static inline uint64_t Bucket(const uint64_t hash, const uint64_t n) {
+		return hash_jump_bucket(hash, n);
+	}
+};
+
+template <class OP>
+uint64_t CheckBucketCount(const int64_t bucket_count) {
+	if (bucket_count < 1 || bucket_count > OP::MAX_BUCKETS) {
+		throw InvalidInputException("%s: bucket count must be between 1 and %d, got %d", OP::NAME, OP::MAX_BUCKETS,
+		                            bucket_count);
+	}
+	return static_cast<uint64_t>(bucket_count);
+}
+
+template <class OP>
+unique_ptr<FunctionData> HashBucketBind(ClientContext &context, ScalarFunction &bound_function,
+                                        vector<unique_ptr<Expression>> &arguments) {
+	auto &input_type = arguments[0]->return_type;
+	if (!hash_vector_supports_type(input_type)) {
+		throw BinderException("%s: unsupported value type %s", OP::NAME, input_type.ToString());
+	}
+	auto algorithm = HashAlgorithm::XXH3_64;
+	bool hash_input = !OP::ACCEPTS_HASH || input_type.id() != LogicalTypeId::UBIGINT;
+	if (arguments.size() > 2) {
+		auto algo = GetConstantArgument(context, *arguments[2], OP::NAME, "algo");
+		algorithm = hash_algorithm_64_from_name(OP::NAME, StringValue::Get(algo));
+		hash_input = true;
+	}
+	uint64_t bucket_count = 0;
+	if (arguments[1]->IsFoldable()) {
+		auto value = ExpressionExecutor::EvaluateScalar(context, *arguments[1]);
+		if (!value.IsNull()) {
+			const auto n = value.GetValue<int64_t>();
+			if (n < 1 || n > OP::MAX_BUCKETS) {
+				throw BinderException("%s: bucket count must be between 1 and %d, got %d", OP::NAME, OP::MAX_BUCKETS,
+				                      n);
+			}
+			bucket_count = static_cast<uint64_t>(n);
+		}
+	}
+	return make_uniq<HashBucketBindData>(algorithm, hash_input, bucket_count);
+}
+
+// Copy precomputed 64-bit hashes into the result as the digests to reduce
+void CopyInputHashes(Vector &input, const idx_t row_count, Vector &result) {
+	UnifiedVectorFormat vdata;
+	input.ToUnifiedFormat(row_count, vdata);
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto inputs = UnifiedVectorFormat::GetData<uint64_t>(vdata);
+	auto digests = FlatVector::GetData<uint64_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto input_idx = vdata.sel->get_index(i);
+		if (!vdata.validity.RowIsValid(input_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		digests[i] = inputs[input_idx];
+	}
+}
+
+template <class OP>
+void HashBucketFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<HashBucketBindData>();
+	const auto row_count = args.size();
+
+	// Digests land in the BIGINT result and are replaced by their bucket below
+	if (bind_data.hash_input) {
+		hash_vector_64(bind_data.algorithm, args.data[0], row_count, result);
+	} else {
+		CopyInputHashes(args.data[0], row_count, result);
+	}
+	auto digests = FlatVector::GetData<uint64_t>(result);
+	auto buckets = FlatVector::GetData<int64_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+
+	if (bind_data.bucket_count != 0) {
+		const auto n = bind_data.bucket_count;
+		if (result_validity.AllValid()) {
+			for (idx_t i = 0; i < row_count; i++) {
+				buckets[i] = static_cast<int64_t>(OP::Bucket(digests[i], n));
+			}
+		} else {
+			for (idx_t i = 0; i < row_count; i++) {
+				if (result_validity.RowIsValid(i)) {
+					buckets[i] = static_cast<int64_t>(OP::Bucket(digests[i], n));
+				}
+			}
+		}
+		return;
+	}
+
+	UnifiedVectorFormat count_vdata;
+	args.data[1].ToUnifiedFormat(row_count, count_vdata);
+	auto counts = UnifiedVectorFormat::GetData<int64_t>(count_vdata);
+	for (idx_t i = 0; i < row_count; i++) {
+		if (!result_validity.RowIsValid(i)) {
+			continue;
+		}
+		const auto count_idx = count_vdata.sel->get_index(i);
+		if (!count_vdata.validity.RowIsValid(count_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		buckets[i] = static_cast<int64_t>(OP::Bucket(digests[i], CheckBucketCount<OP>(counts[count_idx])));
+	}
+}
+
+template <class OP>
+ScalarFunctionSet GetHashBucketFunctionSet() {
+	ScalarFunctionSet set(OP::NAME);
+	set.AddFunction(ScalarFunction({LogicalType::ANY, LogicalType::BIGINT}, LogicalType::BIGINT,
+	                               HashBucketFunction<OP>, HashBucketBind<OP>));
+	set.AddFunction(ScalarFunction({LogicalType::ANY, LogicalType::BIGINT, LogicalType::VARCHAR}, LogicalType::BIGINT,
+	                               HashBucketFunction<OP>, HashBucketBind<OP>));
+	return set;
+}
+
+} // namespace
+
+void RegisterHashBucketFunctions(ExtensionLoader &loader) {
+	CreateScalarFunctionInfo hash_bucket_info(GetHashBucketFunctionSet<MultiplyHighBucket>());
+	hash_bucket_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::BIGINT, LogicalType::VARCHAR},
+	     /* parameter_names */ {"value", "n", "algo"},
+	     /* description */
+	     "Maps a value to a bucket in [0, n) as floor(hash * n / 2^64), a division-free replacement for hash % n "
+	     "that splits the hash space evenly. algo is xxh3_64 (default), xxh64 or rapidhash",
+	     /* examples */ {"hash_bucket(customer_id, 256)", "hash_bucket(customer_id, 256, 'rapidhash')"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(hash_bucket_info);
+
+	CreateScalarFunctionInfo jump_hash_info(GetHashBucketFunctionSet<JumpBucket>());
+	jump_hash_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::BIGINT, LogicalType::VARCHAR},
+	     /* parameter_names */ {"value", "n", "algo"},
+	     /* description */
+	     "Maps a value to one of n buckets with jump consistent hashing: growing n to n + 1 moves only the keys that "
+	     "land in the new bucket. A UBIGINT value without algo is used as a precomputed hash; other values are "
+	     "hashed with algo, xxh3_64 (default), xxh64 or rapidhash",
+	     /* examples */ {"jump_hash(user_id, 64)", "jump_hash(xxh3_64(user_id), 64)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(jump_hash_info);
+}
+
+} // namespace duckdb
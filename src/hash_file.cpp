@@ -0,0 +1,490 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// File hashing table functions.
+//
+// Files are read through DuckDB's FileSystem (so local paths and any registered file system such as httpfs work) in
+// large sequential reads and fed to the xxHash streaming APIs, so files of any size hash in constant memory. Each
+// invocation of the table function claims whole files from a shared counter; DuckDB runs the function on as many
+// threads as there are files, so a glob over many files is hashed in parallel.
+static constexpr idx_t HASH_FILE_READ_SIZE = idx_t(4) << 20;
+
+enum class FileHashAlgorithm : uint8_t { XXH32, XXH64, XXH3_64, XXH3_128 };
+
+FileHashAlgorithm ParseFileHashAlgorithm(const Value &value, const char *function_name) {
+	if (value.IsNull()) {
+		throw BinderException("%s: algo cannot be NULL", function_name);
+	}
+	const auto name = StringUtil::Lower(StringValue::Get(value));
+	if (name == "xxh32") {
+		return FileHashAlgorithm::XXH32;
+	} else if (name == "xxh64") {
+		return FileHashAlgorithm::XXH64;
+	} else if (name == "xxh3_64") {
+		return FileHashAlgorithm::XXH3_64;
+	} else if (name == "xxh3_128") {
+		return FileHashAlgorithm::XXH3_128;
+	}
+	throw BinderException("%s: unsupported algo '%s', expected one of xxh32, xxh64, xxh3_64, xxh3_128", function_name,
+	                      StringValue::Get(value));
+}
+
+// Incremental digest over the xxHash streaming APIs. Digests are rendered as lowercase hex: the 32- and 64-bit
+// algorithms as the hex value of the integer the scalar functions return, xxh3_128 exactly like xxh3_128_hex.
+class StreamingDigest {
+public:
+	explicit StreamingDigest(FileHashAlgorithm algorithm_p) : algorithm(algorithm_p) {
+		switch (algorithm) {
+		case FileHashAlgorithm::XXH32:
+			xxh32_state = XXH32_createState();
+			break;
+		case FileHashAlgorithm::XXH64:
+			xxh64_state = XXH64_createState();
+			break;
+		default:
+			xxh3_state = XXH3_createState();
+			break;
+		}
+		if (!xxh32_state && !xxh64_state && !xxh3_state) {
+			throw OutOfMemoryException("failed to allocate xxHash streaming state");
+		}
+	}
+
+	~StreamingDigest() {
+		XXH32_freeState(xxh32_state);
+		XXH64_freeState(xxh64_state);
+		XXH3_freeState(xxh3_state);
+	}
+
+	StreamingDigest(const StreamingDigest &) = delete;
+	StreamingDigest &operator=(const StreamingDigest &) = delete;
+
+	void Reset() {
+		switch (algorithm) {
+		case FileHashAlgorithm::XXH32:
+			XXH32_reset(xxh32_state, 0);
+			break;
+		case FileHashAlgorithm::XXH64:
+			XXH64_reset(xxh64_state, 0);
+			break;
+		case FileHashAlgorithm::XXH3_64:
+			XXH3_64bits_reset(xxh3_state);
+			break;
+		case FileHashAlgorithm::XXH3_128:
+			XXH3_128bits_reset(xxh3_state);
+			break;
+		}
+	}
+
+	void Update(const_data_ptr_t data, const idx_t size) {
+		switch (algorithm) {
+		case FileHashAlgorithm::XXH32:
+			XXH32_update(xxh32_state, data, size);
+			break;
+		case FileHashAlgorithm::XXH64:
+			XXH64_update(xxh64_state, data, size);
+			break;
+		case FileHashAlgorithm::XXH3_64:
+			XXH3_64bits_update(xxh3_state, data, size);
+			break;
+		case FileHashAlgorithm::XXH3_128:
+			XXH3_128bits_update(xxh3_state, data, size);
+			break;
+		}
+	}
+
+	string HexDigest() const {
+		char hex_buf[33];
+		switch (algorithm) {
+		case FileHashAlgorithm::XXH32:
+			snprintf(hex_buf, sizeof(hex_buf), "%08x", static_cast<unsigned int>(XXH32_digest(xxh32_state)));
+			break;
+		case FileHashAlgorithm::XXH64:
+			snprintf(hex_buf, sizeof(hex_buf), "%016llx",
+			         static_cast<unsigned long long>(XXH64_digest(xxh64_state)));
+			break;
+		case FileHashAlgorithm::XXH3_64:
+			snprintf(hex_buf, sizeof(hex_buf), "%016llx",
+			         static_cast<unsigned long long>(XXH3_64bits_digest(xxh3_state)));
+			break;
+		case FileHashAlgorithm::XXH3_128:
+			hash_xxh128_hex(XXH3_128bits_digest(xxh3_state), hex_buf);
+			break;
+		}
+		return string(hex_buf);
+	}
+
+	// Digest in xxHash canonical (big-endian) order, as printed by xxhsum; differs from HexDigest only for xxh3_128
+	string CanonicalHexDigest() const {
+		if (algorithm != FileHashAlgorithm::XXH3_128) {
+			return HexDigest();
+		}
+		const auto hash128 = XXH3_128bits_digest(xxh3_state);
+		char hex_buf[33];
+		snprintf(hex_buf, sizeof(hex_buf), "%016llx%016llx", static_cast<unsigned long long>(hash128.high64),
+		         static_cast<unsigned long long>(hash128.low64));
+		return string(hex_buf);
+	}
+
+private:
+	FileHashAlgorithm algorithm;
+	XXH32_state_t *xxh32_state = nullptr;
+	XXH64_state_t *xxh64_state = nullptr;
+	XXH3_state_t *xxh3_state = nullptr;
+};
+
+// Per-thread reader: one large read buffer and one digest state per algorithm, reused for every file the thread hashes
+struct FileHasher {
+	explicit FileHasher(Allocator &allocator) : buffer(allocator.Allocate(HASH_FILE_READ_SIZE)) {
+	}
+
+	AllocatedData buffer;
+	unique_ptr<StreamingDigest> digests[4];
+
+	// Hashes the whole file and sets file_size to the number of bytes hashed; the returned digest is valid until the
+	// next call with the same algorithm
+	const StreamingDigest &Hash(ClientContext &context, const string &path, FileHashAlgorithm algorithm,
+	                            idx_t &file_size) {
+		auto &digest = digests[static_cast<uint8_t>(algorithm)];
+		if (!digest) {
+			digest = make_uniq<StreamingDigest>(algorithm);
+		}
+		auto &fs = FileSystem::GetFileSystem(context);
+		auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+		digest->Reset();
+		file_size = 0;
+		while (true) {
+			if (context.interrupted) {
+				throw InterruptException();
+			}
+			const auto bytes_read = handle->Read(buffer.get(), buffer.GetSize());
+			if (bytes_read <= 0) {
+				break;
+			}
+			digest->Update(buffer.get(), static_cast<idx_t>(bytes_read));
+			file_size += static_cast<idx_t>(bytes_read);
+		}
+		return *digest;
+	}
+};
+
+// Work distribution shared by the file hashing table functions: each call claims items from an atomic counter. Every
+// thread has at most one file open, so max_threads also bounds the number of reads in flight.
+struct FileHashGlobalState : public GlobalTableFunctionState {
+	FileHashGlobalState(idx_t item_count_p, idx_t max_threads_p) : item_count(item_count_p), max_threads(max_threads_p) {
+	}
+
+	atomic<idx_t> next_item {0};
+	idx_t item_count;
+	idx_t max_threads;
+
+	idx_t MaxThreads() const override {
+		return MaxValue<idx_t>(MinValue<idx_t>(item_count, max_threads), 1);
+	}
+};
+
+struct FileHashLocalState : public LocalTableFunctionState {
+	explicit FileHashLocalState(Allocator &allocator) : hasher(allocator) {
+	}
+
+	FileHasher hasher;
+};
+
+unique_ptr<LocalTableFunctionState> FileHashInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                      GlobalTableFunctionState *global_state) {
+	return make_uniq<FileHashLocalState>(Allocator::Get(context.client));
+}
+
+struct HashFileBindData : public TableFunctionData {
+	vector<string> paths;
+	FileHashAlgorithm algorithm = FileHashAlgorithm::XXH3_128;
+};
+
+unique_ptr<FunctionData> HashFileBind(ClientContext &context, TableFunctionBindInput &input,
+                                      vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("hash_file: glob cannot be NULL");
+	}
+	auto result = make_uniq<HashFileBindData>();
+	for (auto &param : input.named_parameters) {
+		if (param.first == "algo") {
+			result->algorithm = ParseFileHashAlgorithm(param.second, "hash_file");
+		}
+	}
+	auto &fs = FileSystem::GetFileSystem(context);
+	for (auto &file : fs.GlobFiles(StringValue::Get(input.inputs[0]), context, FileGlobOptions::DISALLOW_EMPTY)) {
+		result->paths.push_back(file.path);
+	}
+
+	return_types = {LogicalType::VARCHAR, LogicalType::UBIGINT, LogicalType::VARCHAR};
+	names = {"path", "size", "digest"};
+	return std::move(result);
+}
+
+unique_ptr<GlobalTableFunctionState> HashFileInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<HashFileBindData>();
+	return make_uniq<FileHashGlobalState>(bind_data.paths.size(), bind_data.paths.size());
+}
+
+void HashFileFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<HashFileBindData>();
+	auto &global_state = data.global_state->Cast<FileHashGlobalState>();
+	auto &local_state = data.local_state->Cast<FileHashLocalState>();
+
+	auto paths = FlatVector::GetData<string_t>(output.data[0]);
+	auto sizes = FlatVector::GetData<uint64_t>(output.data[1]);
+	auto digests = FlatVector::GetData<string_t>(output.data[2]);
+
+	idx_t row = 0;
+	while (row < STANDARD_VECTOR_SIZE) {
+		const auto file_idx = global_state.next_item++;
+		if (file_idx >= bind_data.paths.size()) {
+			break;
+		}
+		const auto &path = bind_data.paths[file_idx];
+		idx_t file_size;
+		const auto digest = local_state.hasher.Hash(context, path, bind_data.algorithm, file_size).HexDigest();
+		paths[row] = StringVector::AddString(output.data[0], path);
+		sizes[row] = file_size;
+		digests[row] = StringVector::AddString(output.data[2], digest);
+		row++;
+	}
+	output.SetCardinality(row);
+}
+
+// Checksum manifests in the formats written by xxhsum:
+//   GNU style  "<digest>  <file>" (or " *<file>" in binary mode); XXH3_64 digests carry an "XXH3_" prefix and the
+//              algorithm of the others follows from the digest length (8: XXH32, 16: XXH64, 32: XXH128)
+//   BSD style  "XXH32 (<file>) = <digest>", also XXH64, XXH3 and XXH128
+// A leading backslash marks a file name with escaped "\\" and "\n". Blank lines and lines starting with '#' are
+// skipped. Relative file names are resolved against the directory of the manifest.
+struct ManifestEntry {
+	string path;
+	FileHashAlgorithm algorithm = FileHashAlgorithm::XXH64;
+	string expected;
+};
+
+bool IsHexString(const string &value) {
+	for (auto c : value) {
+		if (!StringUtil::CharacterIsHex(c)) {
+			return false;
+		}
+	}
+	return !value.empty();
+}
+
+string UnescapeManifestFileName(const string &file_name) {
+	string result;
+	for (idx_t i = 0; i < file_name.size(); i++) {
+		if (file_name[i] == '\\' && i + 1 < file_name.size()) {
+			i++;
+			result += file_name[i] == 'n' ? '\n' : file_name[i];
+		} else {
+			result += file_name[i];
+		}
+	}
+	return result;
+}
+
+// Returns false for lines that carry no entry; throws on lines that are not checksum lines
+bool ParseManifestLine(string line, const string &manifest_path, idx_t line_number, ManifestEntry &entry,
+                       string &file_name) {
+	if (!line.empty() && line.back() == '\r') {
+		line.pop_back();
+	}
+	if (line.empty() || line[0] == '#') {
+		return false;
+	}
+	const bool escaped = line[0] == '\\';
+	if (escaped) {
+		line = line.substr(1);
+	}
+
+	static const std::pair<const char *, FileHashAlgorithm> BSD_TAGS[] = {
+	    {"XXH32 (", FileHashAlgorithm::XXH32},
+	    {"XXH64 (", FileHashAlgorithm::XXH64},
+	    {"XXH3 (", FileHashAlgorithm::XXH3_64},
+	    {"XXH128 (", FileHashAlgorithm::XXH3_128}};
+	string digest;
+	bool parsed = false;
+	for (auto &tag : BSD_TAGS) {
+		const string prefix = tag.first;
+		if (!StringUtil::StartsWith(line, prefix)) {
+			continue;
+		}
+		const auto separator = line.rfind(") = ");
+		if (separator != string::npos && separator >= prefix.size()) {
+			file_name = line.substr(prefix.size(), separator - prefix.size());
+			digest = line.substr(separator + 4);
+			entry.algorithm = tag.second;
+			parsed = true;
+		}
+		break;
+	}
+	if (!parsed) {
+		const auto space = line.find(' ');
+		if (space != string::npos && space + 2 < line.size() && (line[space + 1] == ' ' || line[space + 1] == '*')) {
+			digest = line.substr(0, space);
+			file_name = line.substr(space + 2);
+			parsed = true;
+			if (StringUtil::StartsWith(digest, "XXH3_")) {
+				digest = digest.substr(5);
+				entry.algorithm = FileHashAlgorithm::XXH3_64;
+			} else if (digest.size() == 8) {
+				entry.algorithm = FileHashAlgorithm::XXH32;
+			} else if (digest.size() == 16) {
+				entry.algorithm = FileHashAlgorithm::XXH64;
+			} else if (digest.size() == 32) {
+				entry.algorithm = FileHashAlgorithm::XXH3_128;
+			} else {
+				parsed = false;
+			}
+		}
+	}
+
+	idx_t expected_length = 0;
+	switch (entry.algorithm) {
+	case FileHashAlgorithm::XXH32:
+		expected_length = 8;
+		break;
+	case FileHashAlgorithm::XXH64:
+	case FileHashAlgorithm::XXH3_64:
+		expected_length = 16;
+		break;
+	case FileHashAlgorithm::XXH3_128:
+		expected_length = 32;
+		break;
+	}
+	if (!parsed || file_name.empty() || digest.size() != expected_length || !IsHexString(digest)) {
+		throw InvalidInputException("verify_checksums: line %d of \"%s\" is not an xxhsum checksum line", line_number,
+		                            manifest_path);
+	}
+	if (escaped) {
+		file_name = UnescapeManifestFileName(file_name);
+	}
+	entry.expected = StringUtil::Lower(digest);
+	return true;
+}
+
+struct VerifyChecksumsBindData : public TableFunctionData {
+	vector<ManifestEntry> entries;
+	idx_t max_concurrency = NumericLimits<idx_t>::Maximum();
+};
+
+unique_ptr<FunctionData> VerifyChecksumsBind(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs[0].IsNull()) {
+		throw BinderException("verify_checksums: manifest_path cannot be NULL");
+	}
+	auto result = make_uniq<VerifyChecksumsBindData>();
+	for (auto &param : input.named_parameters) {
+		if (param.first == "max_concurrency") {
+			if (param.second.IsNull() || param.second.GetValue<int64_t>() < 1) {
+				throw BinderException("verify_checksums: max_concurrency must be at least 1");
+			}
+			result->max_concurrency = static_cast<idx_t>(param.second.GetValue<int64_t>());
+		}
+	}
+
+	const auto manifest_path = StringValue::Get(input.inputs[0]);
+	auto &fs = FileSystem::GetFileSystem(context);
+	auto handle = fs.OpenFile(manifest_path, FileFlags::FILE_FLAGS_READ);
+	string contents(static_cast<idx_t>(handle->GetFileSize()), '\0');
+	if (!contents.empty()) {
+		handle->Read(&contents[0], contents.size(), 0);
+	}
+
+	const auto separator = manifest_path.find_last_of("/\\");
+	const auto directory = separator == string::npos ? string() : manifest_path.substr(0, separator);
+	idx_t line_number = 0;
+	idx_t line_start = 0;
+	while (line_start <= contents.size()) {
+		auto line_end = contents.find('\n', line_start);
+		if (line_end == string::npos) {
+			line_end = contents.size();
+		}
+		line_number++;
+		ManifestEntry entry;
+		string file_name;
+		if (ParseManifestLine(contents.substr(line_start, line_end - line_start), manifest_path, line_number, entry,
+		                      file_name)) {
+			entry.path = directory.empty() || fs.IsPathAbsolute(file_name) ? file_name : fs.JoinPath(directory, file_name);
+			result->entries.push_back(std::move(entry));
+		}
+		line_start = line_end + 1;
+	}
+
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR};
+	names = {"path", "status", "expected", "actual"};
+	return std::move(result);
+}
+
+unique_ptr<GlobalTableFunctionState> VerifyChecksumsInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<VerifyChecksumsBindData>();
+	return make_uniq<FileHashGlobalState>(bind_data.entries.size(), bind_data.max_concurrency);
+}
+
+// Emits one row per file that is missing or whose digest differs from the manifest; verified files produce no rows
+void VerifyChecksumsFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<VerifyChecksumsBindData>();
+	auto &global_state = data.global_state->Cast<FileHashGlobalState>();
+	auto &local_state = data.local_state->Cast<FileHashLocalState>();
+	auto &fs = FileSystem::GetFileSystem(context);
+
+	auto paths = FlatVector::GetData<string_t>(output.data[0]);
+	auto statuses = FlatVector::GetData<string_t>(output.data[1]);
+	auto expected = FlatVector::GetData<string_t>(output.data[2]);
+	auto actual = FlatVector::GetData<string_t>(output.data[3]);
+
+	idx_t row = 0;
+	while (row < STANDARD_VECTOR_SIZE) {
+		const auto entry_idx = global_state.next_item++;
+		if (entry_idx >= bind_data.entries.size()) {
+			break;
+		}
+		const auto &entry = bind_data.entries[entry_idx];
+		if (!fs.FileExists(entry.path)) {
+			statuses[row] = StringVector::AddString(output.data[1], "MISSING");
+			FlatVector::SetNull(output.data[3], row, true);
+		} else {
+			idx_t file_size;
+			const auto digest =
+			    local_state.hasher.Hash(context, entry.path, entry.algorithm, file_size).CanonicalHexDigest();
+			if (digest == entry.expected) {
+				continue;
+			}
+			statuses[row] = StringVector::AddString(output.data[1], "MISMATCH");
+			actual[row] = StringVector::AddString(output.data[3], digest);
+		}
+		paths[row] = StringVector::AddString(output.data[0], entry.path);
+		expected[row] = StringVector::AddString(output.data[2], entry.expected);
+		row++;
+	}
+	output.SetCardinality(row);
+}
+
+} // namespace
+
+void RegisterFileHashFunctions(ExtensionLoader &loader) {
+	TableFunction hash_file("hash_file", {LogicalType::VARCHAR}, HashFileFunction, HashFileBind, HashFileInitGlobal,
+	                        FileHashInitLocal);
+	hash_file.named_parameters["algo"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(hash_file);
+
+	TableFunction verify_checksums("verify_checksums", {LogicalType::VARCHAR}, VerifyChecksumsFunction,
+	                               VerifyChecksumsBind, VerifyChecksumsInitGlobal, FileHashInitLocal);
+	verify_checksums.named_parameters["max_concurrency"] = LogicalType::BIGINT;
+	loader.RegisterFunction(verify_checksums);
+}
+
+} // namespace duckdb
@@ -0,0 +1,129 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Commutative multiset fingerprints for window frames.
+//
+// hash_fingerprint(value) is the sum modulo 2^128 of the xxh3_128 digests of the non-NULL values, hashed with the
+// row kernel so a whole row can be fingerprinted as hash_fingerprint(t). The sum forms a group: states merge by
+// addition and a fingerprint is removed from another by subtraction. The state is a fixed-size POD without a
+// destructor, so DuckDB's window operator builds its segment tree over it and evaluates every frame of
+// ROWS n PRECEDING with O(log n) state combines instead of rehashing each frame's rows. The inverse is exposed as
+// hash_fingerprint_subtract for prefix-sum style differencing of running fingerprints.
+struct HashFingerprintState {
+	uhugeint_t sum;
+	uint64_t count;
+};
+
+struct HashFingerprintOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.sum = uhugeint_t(0);
+		state.count = 0;
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		hash_digest_add(target.sum, source.sum);
+		target.count += source.count;
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+		if (state.count == 0) {
+			finalize_data.ReturnNull();
+			return;
+		}
+		target = state.sum;
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+void HashFingerprintUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count,
+                           Vector &state_vector, idx_t count) {
+	vector<uhugeint_t> digests(count);
+	ValidityMask digest_validity(count);
+	hash_column_xxh3_128(inputs[0], count, digest_validity, digests.data());
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<HashFingerprintState *>(sdata);
+	for (idx_t i = 0; i < count; i++) {
+		if (!digest_validity.RowIsValid(i)) {
+			continue;
+		}
+		auto &state = *states[sdata.sel->get_index(i)];
+		hash_digest_add(state.sum, digests[i]);
+		state.count++;
+	}
+}
+
+unique_ptr<FunctionData> HashFingerprintBind(ClientContext &context, AggregateFunction &function,
+                                             vector<unique_ptr<Expression>> &arguments) {
+	if (!hash_row_supports_type(arguments[0]->return_type)) {
+		throw BinderException("hash_fingerprint: unsupported value type %s", arguments[0]->return_type.ToString());
+	}
+	return nullptr;
+}
+
+inline void HashFingerprintSubtractFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	BinaryExecutor::Execute<uhugeint_t, uhugeint_t, uhugeint_t>(
+	    args.data[0], args.data[1], result, args.size(), [](uhugeint_t total, const uhugeint_t &part) {
+		    hash_digest_subtract(total, part);
+		    return total;
+	    });
+}
+
+} // namespace
+
+void RegisterHashFingerprintFunctions(ExtensionLoader &loader) {
+	AggregateFunctionSet fingerprint_set("hash_fingerprint");
+	AggregateFunction fingerprint(
+	    {LogicalType::ANY}, LogicalType::UHUGEINT, AggregateFunction::StateSize<HashFingerprintState>,
+	    AggregateFunction::StateInitialize<HashFingerprintState, HashFingerprintOperation>, HashFingerprintUpdate,
+	    AggregateFunction::StateCombine<HashFingerprintState, HashFingerprintOperation>,
+	    AggregateFunction::StateFinalize<HashFingerprintState, uhugeint_t, HashFingerprintOperation>, nullptr,
+	    HashFingerprintBind);
+	fingerprint.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+	fingerprint_set.AddFunction(fingerprint);
+	CreateAggregateFunctionInfo fingerprint_info(fingerprint_set);
+	fingerprint_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY},
+	     /* parameter_names */ {"value"},
+	     /* description */
+	     "Order-independent fingerprint of a multiset of values or rows: the sum modulo 2^128 of their xxh3_128 "
+	     "digests. Mergeable and invertible, so window frames are computed from a segment tree instead of "
+	     "rehashing every frame",
+	     /* examples */ {"hash_fingerprint(payload) OVER (PARTITION BY device ORDER BY ts ROWS 1000 PRECEDING)",
+	                     "hash_fingerprint(t)"},
+	     /* categories */ {"hash", "aggregate"}});
+	loader.RegisterFunction(fingerprint_info);
+
+	ScalarFunctionSet subtract_set("hash_fingerprint_subtract");
+	subtract_set.AddFunction(ScalarFunction({LogicalType::UHUGEINT, LogicalType::UHUGEINT}, LogicalType::UHUGEINT,
+	                                        HashFingerprintSubtractFunction));
+	CreateScalarFunctionInfo subtract_info(subtract_set);
+	subtract_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::UHUGEINT, LogicalType::UHUGEINT},
+	     /* parameter_names */ {"total", "part"},
+	     /* description */
+	     "Removes the fingerprint of a sub-multiset from a hash_fingerprint (or digest_sum) result, modulo 2^128. "
+	     "The difference of two running fingerprints is the fingerprint of the rows between them",
+	     /* examples */ {"hash_fingerprint_subtract(running, coalesce(lag(running, 1001) OVER w, 0::UHUGEINT))"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(subtract_info);
+}
+
+} // namespace duckdb
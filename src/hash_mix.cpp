@@ -0,0 +1,255 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Reversible integer mixers.
+//
+// Each mixer alternates xorshifts and multiplications by odd constants, both invertible modulo 2^64 (or 2^32), so it
+// is a bijection and the unmix functions undo it exactly: the xorshift x ^ (x >> s) is undone by repeating it until
+// all shifted bits are consumed, the multiplication by multiplying with the constant's inverse modulo 2^64.
+//
+//   64-bit: splitmix64 (SplitMix64's output function, default) and fmix64 (MurmurHash3's finalizer)
+//   32-bit: lowbias32 (Wellons' hash-prospector mixer, default) and fmix32 (MurmurHash3's finalizer)
+//   keyed:  mix(mix(x ^ k1) ^ k2) with the default mixer, k1 and k2 drawn from the key with SplitMix64
+//
+// A mixer is a handful of instructions per value, applied by a unary executor loop the compiler can vectorize. They
+// scramble sequential IDs but are not encryption: the unkeyed mixers are public, and the keyed one is not a secure
+// cipher.
+template <class T>
+inline T UnXorShift(const T x, const idx_t shift) {
+	T result = x;
+	for (idx_t consumed = shift; consumed < sizeof(T) * 8; consumed += shift) {
+		result = x ^ (result >> shift);
+	}
+	return result;
+}
+
+struct SplitMix64Mixer {
+	using TYPE = uint64_t;
+	static constexpr const char *NAME = "splitmix64";
+
+	static inline uint64_t Mix(const uint64_t x) {
+		return hash_splitmix64_mix(x);
+	}
+
+	static inline uint64_t Unmix(uint64_t z) {
+		z = UnXorShift<uint64_t>(z, 31) * 0x319642b2d24d8ec3ULL;
+		z = UnXorShift<uint64_t>(z, 27) * 0x96de1b173f119089ULL;
+		return UnXorShift<uint64_t>(z, 30);
+	}
+};
+
+struct FMix64Mixer {
+	using TYPE = uint64_t;
+	static constexpr const char *NAME = "fmix64";
+
+	static inline uint64_t Mix(const uint64_t x) {
+		return hash_fmix64(x);
+	}
+
+	static inline uint64_t Unmix(uint64_t k) {
+		k = UnXorShift<uint64_t>(k, 33) * 0x9cb4b2f8129337dbULL;
+		k = UnXorShift<uint64_t>(k, 33) * 0x4f74430c22a54005ULL;
+		return UnXorShift<uint64_t>(k, 33);
+	}
+};
+
+struct LowBias32Mixer {
+	using TYPE = uint32_t;
+	static constexpr const char *NAME = "lowbias32";
+
+	static inline uint32_t Mix(uint32_t x) {
+		x = (x ^ (x >> 16)) * 0x7feb352dU;
+		x = (x ^ (x >> 15)) * 0x846ca68bU;
+		return x ^ (x >> 16);
+	}
+
+	static inline uint32_t Unmix(uint32_t x) {
+		x = UnXorShift<uint32_t>(x, 16) * 0x43021123U;
+		x = UnXorShift<uint32_t>(x, 15) * 0x1d69e2a5U;
+		return UnXorShift<uint32_t>(x, 16);
+	}
+};
+
+struct FMix32Mixer {
+	using TYPE = uint32_t;
+	static constexpr const char *NAME = "fmix32";
+
+	static inline uint32_t Mix(uint32_t h) {
+		h = (h ^ (h >> 16)) * 0x85ebca6bU;
+		h = (h ^ (h >> 13)) * 0xc2b2ae35U;
+		return h ^ (h >> 16);
+	}
+
+	static inline uint32_t Unmix(uint32_t h) {
+		h = UnXorShift<uint32_t>(h, 16) * 0x7ed1b41dU;
+		h = UnXorShift<uint32_t>(h, 13) * 0xa5cb9243U;
+		return UnXorShift<uint32_t>(h, 16);
+	}
+};
+
+enum class MixVariant : uint8_t { DEFAULT, ALTERNATE, KEYED };
+
+template <class T>
+struct MixKeys {
+	T first;
+	T second;
+};
+
+template <class T>
+MixKeys<T> ExpandMixKey(uint64_t key) {
+	const auto first = hash_splitmix64(key);
+	const auto second = hash_splitmix64(key);
+	return {static_cast<T>(first), static_cast<T>(second)};
+}
+
+struct MixBindData : public FunctionData {
+	MixBindData(const MixVariant variant_p, const bool constant_key_p, const uint64_t key_p)
+	    : variant(variant_p), constant_key(constant_key_p), key(key_p) {
+	}
+
+	MixVariant variant;
+	//! Whether a keyed mix has a constant key, expanded once; otherwise the key is read per row
+	bool constant_key;
+	uint64_t key;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<MixBindData>(variant, constant_key, key);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<MixBindData>();
+		return variant == other.variant && constant_key == other.constant_key && key == other.key;
+	}
+};
+
+template <class DEFAULT_MIXER, class ALTERNATE_MIXER>
+unique_ptr<FunctionData> MixBind(ClientContext &context, ScalarFunction &bound_function,
+                                 vector<unique_ptr<Expression>> &arguments) {
+	if (arguments.size() == 1) {
+		return make_uniq<MixBindData>(MixVariant::DEFAULT, false, 0);
+	}
+	if (bound_function.arguments[1].id() == LogicalTypeId::VARCHAR) {
+		auto algo = GetConstantArgument(context, *arguments[1], bound_function.name, "algo");
+		const auto name = StringUtil::Lower(StringValue::Get(algo));
+		if (name == DEFAULT_MIXER::NAME) {
+			return make_uniq<MixBindData>(MixVariant::DEFAULT, false, 0);
+		}
+		if (name == ALTERNATE_MIXER::NAME) {
+			return make_uniq<MixBindData>(MixVariant::ALTERNATE, false, 0);
+		}
+		throw BinderException("%s: unsupported algo '%s', expected %s or %s", bound_function.name,
+		                      StringValue::Get(algo), DEFAULT_MIXER::NAME, ALTERNATE_MIXER::NAME);
+	}
+	if (arguments[1]->IsFoldable()) {
+		auto key = ExpressionExecutor::EvaluateScalar(context, *arguments[1]);
+		if (!key.IsNull()) {
+			return make_uniq<MixBindData>(MixVariant::KEYED, true,
+			                              key.DefaultCastAs(LogicalType::UBIGINT).GetValue<uint64_t>());
+		}
+	}
+	return make_uniq<MixBindData>(MixVariant::KEYED, false, 0);
+}
+
+template <class DEFAULT_MIXER, class ALTERNATE_MIXER, bool INVERSE>
+void MixFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	using T = typename DEFAULT_MIXER::TYPE;
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<MixBindData>();
+	auto &input = args.data[0];
+	const auto row_count = args.size();
+
+	// Signed inputs are mixed as their two's complement bits, so the result round-trips through the same type
+	switch (bind_data.variant) {
+	case MixVariant::DEFAULT:
+		UnaryExecutor::Execute<T, T>(input, result, row_count,
+		                             [](T x) { return INVERSE ? DEFAULT_MIXER::Unmix(x) : DEFAULT_MIXER::Mix(x); });
+		break;
+	case MixVariant::ALTERNATE:
+		UnaryExecutor::Execute<T, T>(input, result, row_count,
+		                             [](T x) { return INVERSE ? ALTERNATE_MIXER::Unmix(x) : ALTERNATE_MIXER::Mix(x); });
+		break;
+	case MixVariant::KEYED: {
+		auto keyed = [](T x, const MixKeys<T> &keys) {
+			if (INVERSE) {
+				return static_cast<T>(DEFAULT_MIXER::Unmix(DEFAULT_MIXER::Unmix(x) ^ keys.second) ^ keys.first);
+			}
+			return DEFAULT_MIXER::Mix(DEFAULT_MIXER::Mix(x ^ keys.first) ^ keys.second);
+		};
+		if (bind_data.constant_key) {
+			const auto keys = ExpandMixKey<T>(bind_data.key);
+			UnaryExecutor::Execute<T, T>(input, result, row_count, [&](T x) { return keyed(x, keys); });
+		} else {
+			BinaryExecutor::Execute<T, uint64_t, T>(input, args.data[1], result, row_count, [&](T x, uint64_t key) {
+				return keyed(x, ExpandMixKey<T>(key));
+			});
+		}
+		break;
+	}
+	}
+}
+
+template <class DEFAULT_MIXER, class ALTERNATE_MIXER, bool INVERSE>
+ScalarFunctionSet GetMixFunctionSet(const string &name, const vector<LogicalType> &types) {
+	ScalarFunctionSet set(name);
+	auto function = MixFunction<DEFAULT_MIXER, ALTERNATE_MIXER, INVERSE>;
+	auto bind = MixBind<DEFAULT_MIXER, ALTERNATE_MIXER>;
+	for (auto &type : types) {
+		set.AddFunction(ScalarFunction({type}, type, function, bind));
+		set.AddFunction(ScalarFunction({type, LogicalType::VARCHAR}, type, function, bind));
+		set.AddFunction(ScalarFunction({type, LogicalType::UBIGINT}, type, function, bind));
+	}
+	return set;
+}
+
+template <class DEFAULT_MIXER, class ALTERNATE_MIXER, bool INVERSE>
+void RegisterMixFunction(ExtensionLoader &loader, const string &name, const LogicalType &signed_type,
+                         const LogicalType &unsigned_type, const string &description, const string &example) {
+	CreateScalarFunctionInfo info(
+	    GetMixFunctionSet<DEFAULT_MIXER, ALTERNATE_MIXER, INVERSE>(name, {signed_type, unsigned_type}));
+	info.descriptions.push_back({/* parameter_types */ {signed_type, LogicalType::VARCHAR},
+	                             /* parameter_names */ {"x", "algo"},
+	                             /* description */ description,
+	                             /* examples */ {example},
+	                             /* categories */ {"hash"}});
+	info.descriptions.push_back({/* parameter_types */ {signed_type, LogicalType::UBIGINT},
+	                             /* parameter_names */ {"x", "key"},
+	                             /* description */ description,
+	                             /* examples */ {example},
+	                             /* categories */ {"hash"}});
+	loader.RegisterFunction(info);
+}
+
+} // namespace
+
+void RegisterHashMixFunctions(ExtensionLoader &loader) {
+	RegisterMixFunction<SplitMix64Mixer, FMix64Mixer, false>(
+	    loader, "mix64", LogicalType::BIGINT, LogicalType::UBIGINT,
+	    "Bijective 64-bit integer mixer, a few instructions per value: algo is splitmix64 (default) or fmix64, or a "
+	    "key selects a keyed mix. Reversed by unmix64 with the same algo or key",
+	    "mix64(order_id, 42)");
+	RegisterMixFunction<SplitMix64Mixer, FMix64Mixer, true>(
+	    loader, "unmix64", LogicalType::BIGINT, LogicalType::UBIGINT,
+	    "Inverse of mix64 with the same algo or key: unmix64(mix64(x)) = x", "unmix64(public_id, 42)");
+	RegisterMixFunction<LowBias32Mixer, FMix32Mixer, false>(
+	    loader, "mix32", LogicalType::INTEGER, LogicalType::UINTEGER,
+	    "Bijective 32-bit integer mixer: algo is lowbias32 (default) or fmix32, or a key selects a keyed mix. "
+	    "Reversed by unmix32 with the same algo or key",
+	    "mix32(user_id::INTEGER, 'fmix32')");
+	RegisterMixFunction<LowBias32Mixer, FMix32Mixer, true>(
+	    loader, "unmix32", LogicalType::INTEGER, LogicalType::UINTEGER,
+	    "Inverse of mix32 with the same algo or key: unmix32(mix32(x)) = x", "unmix32(public_id, 'fmix32')");
+}
+
+} // namespace duckdb
@@ -0,0 +1,217 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Keyed bijections on [0, n) for shuffling without a sort.
+//
+// A balanced Feistel network permutes the 2k-bit integers, 2^(2k) being the smallest power of four >= n: with the
+// halves (L, R), each round maps them to (R, L ^ F(R)), F(R) = fmix64(R ^ key) masked to k bits. Any round function
+// gives a bijection. The round keys are drawn from the seed with SplitMix64. Outputs outside [0, n) are encrypted
+// again (cycle walking) until they land inside, which restricts the permutation to [0, n). The domain is less than
+// 4n, so that takes fewer than four rounds of the network on average.
+//
+// With constant n and seed the network is keyed once at bind, every index of the vector is encrypted in one pass,
+// and only the indexes that walked out of range are encrypted again.
+static constexpr idx_t FEISTEL_ROUNDS = 6;
+
+class FeistelPermutation {
+public:
+	void Initialize(const uint64_t n_p, uint64_t seed) {
+		n = n_p;
+		// Bits needed for n - 1, split into two halves of at least one bit
+		idx_t bits = 0;
+		while (bits < 64 && ((n - 1) >> bits) != 0) {
+			bits++;
+		}
+		half_bits = MaxValue<idx_t>((bits + 1) / 2, 1);
+		half_mask = (uint64_t(1) << half_bits) - 1;
+		for (auto &key : keys) {
+			key = hash_splitmix64(seed);
+		}
+	}
+
+	// One pass of the network over the 2k-bit domain
+	inline uint64_t Encrypt(const uint64_t x) const {
+		uint64_t left = x >> half_bits;
+		uint64_t right = x & half_mask;
+		for (idx_t round = 0; round < FEISTEL_ROUNDS; round++) {
+			const auto next = left ^ (hash_fmix64(right ^ keys[round]) & half_mask);
+			left = right;
+			right = next;
+		}
+		return (left << half_bits) | right;
+	}
+
+	inline uint64_t Permute(const uint64_t index) const {
+		auto x = Encrypt(index);
+		while (x >= n) {
+			x = Encrypt(x);
+		}
+		return x;
+	}
+
+	uint64_t Size() const {
+		return n;
+	}
+
+	bool operator==(const FeistelPermutation &other) const {
+		return n == other.n && memcmp(keys, other.keys, sizeof(keys)) == 0;
+	}
+
+private:
+	uint64_t n = 0;
+	idx_t half_bits = 0;
+	uint64_t half_mask = 0;
+	uint64_t keys[FEISTEL_ROUNDS] = {};
+};
+
+uint64_t CheckPermutationSize(const int64_t n) {
+	if (n < 1) {
+		throw InvalidInputException("hash_permute: n must be at least 1, got %d", n);
+	}
+	return static_cast<uint64_t>(n);
+}
+
+inline void CheckPermutationIndex(const int64_t index, const uint64_t n) {
+	if (index < 0 || static_cast<uint64_t>(index) >= n) {
+		throw InvalidInputException("hash_permute: index %d is outside [0, %d)", index, n);
+	}
+}
+
+struct HashPermuteBindData : public FunctionData {
+	//! Whether permutation holds the network for constant n and seed; otherwise it is keyed per row
+	bool constant_permutation = false;
+	FeistelPermutation permutation;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto copy = make_uniq<HashPermuteBindData>();
+		copy->constant_permutation = constant_permutation;
+		copy->permutation = permutation;
+		return std::move(copy);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<HashPermuteBindData>();
+		return constant_permutation == other.constant_permutation && permutation == other.permutation;
+	}
+};
+
+unique_ptr<FunctionData> HashPermuteBind(ClientContext &context, ScalarFunction &bound_function,
+                                         vector<unique_ptr<Expression>> &arguments) {
+	auto bind_data = make_uniq<HashPermuteBindData>();
+	const bool seeded = arguments.size() > 2;
+	if (!arguments[1]->IsFoldable() || (seeded && !arguments[2]->IsFoldable())) {
+		return std::move(bind_data);
+	}
+	auto n = ExpressionExecutor::EvaluateScalar(context, *arguments[1]);
+	auto seed = seeded ? ExpressionExecutor::EvaluateScalar(context, *arguments[2]) : Value::UBIGINT(0);
+	if (n.IsNull() || seed.IsNull()) {
+		return std::move(bind_data);
+	}
+	bind_data->permutation.Initialize(CheckPermutationSize(n.DefaultCastAs(LogicalType::BIGINT).GetValue<int64_t>()),
+	                                  seed.DefaultCastAs(LogicalType::UBIGINT).GetValue<uint64_t>());
+	bind_data->constant_permutation = true;
+	return std::move(bind_data);
+}
+
+void HashPermuteFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<HashPermuteBindData>();
+	const auto row_count = args.size();
+
+	UnifiedVectorFormat index_vdata;
+	args.data[0].ToUnifiedFormat(row_count, index_vdata);
+	auto indexes = UnifiedVectorFormat::GetData<int64_t>(index_vdata);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto positions = FlatVector::GetData<uint64_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+
+	if (bind_data.constant_permutation) {
+		auto &permutation = bind_data.permutation;
+		const auto n = permutation.Size();
+		// Encrypt every index once, collecting the rows whose output is outside [0, n)
+		sel_t walking[STANDARD_VECTOR_SIZE];
+		idx_t walking_count = 0;
+		for (idx_t i = 0; i < row_count; i++) {
+			const auto index_idx = index_vdata.sel->get_index(i);
+			if (!index_vdata.validity.RowIsValid(index_idx)) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			CheckPermutationIndex(indexes[index_idx], n);
+			positions[i] = permutation.Encrypt(static_cast<uint64_t>(indexes[index_idx]));
+			walking[walking_count] = static_cast<sel_t>(i);
+			walking_count += positions[i] >= n;
+		}
+		// Walk the remaining rows back into range, one pass of the network at a time
+		while (walking_count > 0) {
+			idx_t still_walking = 0;
+			for (idx_t w = 0; w < walking_count; w++) {
+				const auto i = walking[w];
+				positions[i] = permutation.Encrypt(positions[i]);
+				walking[still_walking] = i;
+				still_walking += positions[i] >= n;
+			}
+			walking_count = still_walking;
+		}
+	} else {
+		UnifiedVectorFormat n_vdata;
+		args.data[1].ToUnifiedFormat(row_count, n_vdata);
+		auto ns = UnifiedVectorFormat::GetData<int64_t>(n_vdata);
+		UnifiedVectorFormat seed_vdata;
+		const bool seeded = args.ColumnCount() > 2;
+		if (seeded) {
+			args.data[2].ToUnifiedFormat(row_count, seed_vdata);
+		}
+		FeistelPermutation permutation;
+		for (idx_t i = 0; i < row_count; i++) {
+			const auto index_idx = index_vdata.sel->get_index(i);
+			const auto n_idx = n_vdata.sel->get_index(i);
+			const auto seed_idx = seeded ? seed_vdata.sel->get_index(i) : 0;
+			if (!index_vdata.validity.RowIsValid(index_idx) || !n_vdata.validity.RowIsValid(n_idx) ||
+			    (seeded && !seed_vdata.validity.RowIsValid(seed_idx))) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			const auto seed = seeded ? UnifiedVectorFormat::GetData<uint64_t>(seed_vdata)[seed_idx] : 0;
+			permutation.Initialize(CheckPermutationSize(ns[n_idx]), seed);
+			CheckPermutationIndex(indexes[index_idx], permutation.Size());
+			positions[i] = permutation.Permute(static_cast<uint64_t>(indexes[index_idx]));
+		}
+	}
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+} // namespace
+
+void RegisterHashPermuteFunctions(ExtensionLoader &loader) {
+	ScalarFunctionSet permute_set("hash_permute");
+	permute_set.AddFunction(ScalarFunction({LogicalType::BIGINT, LogicalType::BIGINT}, LogicalType::BIGINT,
+	                                       HashPermuteFunction, HashPermuteBind));
+	permute_set.AddFunction(ScalarFunction({LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::UBIGINT},
+	                                       LogicalType::BIGINT, HashPermuteFunction, HashPermuteBind));
+	CreateScalarFunctionInfo permute_info(permute_set);
+	permute_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::UBIGINT},
+	     /* parameter_names */ {"index", "n", "seed"},
+	     /* description */
+	     "Keyed pseudo-random permutation of [0, n): maps every index in [0, n) to a distinct position in [0, n), "
+	     "computed per row with a Feistel network, so a table is shuffled without sorting it",
+	     /* examples */ {"hash_permute(row_number() OVER () - 1, 1000000, 42)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(permute_info);
+}
+
+} // namespace duckdb
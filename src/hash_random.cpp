@@ -0,0 +1,152 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Counter-based random numbers keyed by row values.
+//
+// The key (and seed) play the role of the counter: the 64-bit seeded xxh3_64 hash of the key is the random word, so
+// the number drawn for a row depends only on its key and seed, never on execution order or the number of threads.
+//
+//   hash_random(key [, seed])             = (h >> 11) * 2^-53, uniform in [0, 1) on the 53-bit grid of doubles
+//   hash_random_int(key, lo, hi [, seed]) = lo + floor(h * (hi - lo + 1) / 2^64), uniform in [lo, hi]
+//
+// Both hash the whole vector with the shared kernel and convert the hashes in place in a branch-free loop.
+static constexpr double HASH_RANDOM_UNIT = 1.0 / 9007199254740992.0;
+
+void HashRandomWords(DataChunk &args, const idx_t seed_column, Vector &words) {
+	if (args.ColumnCount() > seed_column) {
+		hash_vector_with_seed<uint64_t, HashAlgorithm::XXH3_64>(args.data[0], args.data[seed_column], args.size(),
+		                                                        words);
+	} else {
+		hash_vector<uint64_t, HashAlgorithm::XXH3_64>(args.data[0], args.size(), words);
+	}
+}
+
+unique_ptr<FunctionData> HashRandomBind(ClientContext &context, ScalarFunction &bound_function,
+                                        vector<unique_ptr<Expression>> &arguments) {
+	if (!hash_vector_supports_type(arguments[0]->return_type)) {
+		throw BinderException("%s: unsupported key type %s", bound_function.name, arguments[0]->return_type.ToString());
+	}
+	return nullptr;
+}
+
+void HashRandomFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	const auto row_count = args.size();
+	Vector words(LogicalType::UBIGINT, row_count);
+	HashRandomWords(args, 1, words);
+	auto word_data = FlatVector::GetData<uint64_t>(words);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto randoms = FlatVector::GetData<double>(result);
+	FlatVector::SetValidity(result, FlatVector::Validity(words));
+	for (idx_t i = 0; i < row_count; i++) {
+		randoms[i] = static_cast<double>(word_data[i] >> 11) * HASH_RANDOM_UNIT;
+	}
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+// Number of values in [lo, hi] as an unsigned range; 0 stands for the full 2^64 values of [INT64_MIN, INT64_MAX]
+inline uint64_t HashRandomRange(const int64_t lo, const int64_t hi) {
+	if (lo > hi) {
+		throw InvalidInputException("hash_random_int: lo must not be greater than hi, got [%d, %d]", lo, hi);
+	}
+	return static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo) + 1;
+}
+
+inline int64_t HashRandomInt(const uint64_t word, const int64_t lo, const uint64_t range) {
+	const auto offset = range == 0 ? word : hash_reduce_range(word, range);
+	return static_cast<int64_t>(static_cast<uint64_t>(lo) + offset);
+}
+
+void HashRandomIntFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	const auto row_count = args.size();
+	// The words land in the BIGINT result and are replaced by the drawn integers below
+	HashRandomWords(args, 3, result);
+	auto word_data = FlatVector::GetData<uint64_t>(result);
+	auto ints = FlatVector::GetData<int64_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+
+	auto &lo_vector = args.data[1];
+	auto &hi_vector = args.data[2];
+	if (lo_vector.GetVectorType() == VectorType::CONSTANT_VECTOR &&
+	    hi_vector.GetVectorType() == VectorType::CONSTANT_VECTOR) {
+		if (ConstantVector::IsNull(lo_vector) || ConstantVector::IsNull(hi_vector)) {
+			result.SetVectorType(VectorType::CONSTANT_VECTOR);
+			ConstantVector::SetNull(result, true);
+			return;
+		}
+		const auto lo = *ConstantVector::GetData<int64_t>(lo_vector);
+		const auto range = HashRandomRange(lo, *ConstantVector::GetData<int64_t>(hi_vector));
+		// NULL keys draw from garbage words; their result is masked by the validity
+		for (idx_t i = 0; i < row_count; i++) {
+			ints[i] = HashRandomInt(word_data[i], lo, range);
+		}
+	} else {
+		UnifiedVectorFormat lo_vdata;
+		UnifiedVectorFormat hi_vdata;
+		lo_vector.ToUnifiedFormat(row_count, lo_vdata);
+		hi_vector.ToUnifiedFormat(row_count, hi_vdata);
+		auto los = UnifiedVectorFormat::GetData<int64_t>(lo_vdata);
+		auto his = UnifiedVectorFormat::GetData<int64_t>(hi_vdata);
+		for (idx_t i = 0; i < row_count; i++) {
+			const auto lo_idx = lo_vdata.sel->get_index(i);
+			const auto hi_idx = hi_vdata.sel->get_index(i);
+			if (!result_validity.RowIsValid(i) || !lo_vdata.validity.RowIsValid(lo_idx) ||
+			    !hi_vdata.validity.RowIsValid(hi_idx)) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			ints[i] = HashRandomInt(word_data[i], los[lo_idx], HashRandomRange(los[lo_idx], his[hi_idx]));
+		}
+	}
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+} // namespace
+
+void RegisterHashRandomFunctions(ExtensionLoader &loader) {
+	ScalarFunctionSet random_set("hash_random");
+	random_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::DOUBLE, HashRandomFunction, HashRandomBind));
+	random_set.AddFunction(ScalarFunction({LogicalType::ANY, LogicalType::UBIGINT}, LogicalType::DOUBLE,
+	                                      HashRandomFunction, HashRandomBind));
+	CreateScalarFunctionInfo random_info(random_set);
+	random_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::UBIGINT},
+	     /* parameter_names */ {"key", "seed"},
+	     /* description */
+	     "Reproducible uniform random DOUBLE in [0, 1) derived from the key and seed: the same key and seed always "
+	     "give the same number, whatever the execution order or thread count",
+	     /* examples */ {"hash_random(user_id)", "hash_random(user_id, 2024)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(random_info);
+
+	ScalarFunctionSet random_int_set("hash_random_int");
+	random_int_set.AddFunction(ScalarFunction({LogicalType::ANY, LogicalType::BIGINT, LogicalType::BIGINT},
+	                                          LogicalType::BIGINT, HashRandomIntFunction, HashRandomBind));
+	random_int_set.AddFunction(
+	    ScalarFunction({LogicalType::ANY, LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::UBIGINT},
+	                   LogicalType::BIGINT, HashRandomIntFunction, HashRandomBind));
+	CreateScalarFunctionInfo random_int_info(random_int_set);
+	random_int_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::BIGINT, LogicalType::BIGINT, LogicalType::UBIGINT},
+	     /* parameter_names */ {"key", "lo", "hi", "seed"},
+	     /* description */
+	     "Reproducible uniform random integer in [lo, hi] (both inclusive) derived from the key and seed",
+	     /* examples */ {"hash_random_int(user_id, 1, 6)", "hash_random_int(user_id, 0, 99, 2024)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(random_int_info);
+}
+
+} // namespace duckdb
@@ -0,0 +1,117 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Deterministic hash sampling.
+//
+// hash_sample(value, fraction [, seed]) keeps a value when xxh3_64(value, seed) < fraction * 2^64. The cut-off is
+// computed once at bind, so each row costs one hash and one integer comparison instead of a modulo. The same value
+// is kept in every table (universe sampling, so samples of two tables still join), and a smaller fraction selects a
+// subset of a larger one.
+//
+// The function is deterministic, reads a single column and is registered as unable to throw (bind rejects the types
+// the kernel cannot hash), which lets DuckDB's filter pushdown evaluate it inside the table scan as an expression
+// filter on that column, so rows are dropped before the other columns are fetched.
+struct HashSampleBindData : public FunctionData {
+	HashSampleBindData(const bool keep_all_p, const uint64_t cutoff_p) : keep_all(keep_all_p), cutoff(cutoff_p) {
+	}
+
+	//! Whether fraction >= 1, which keeps every non-NULL value
+	bool keep_all;
+	//! Values whose hash is below the cut-off are kept
+	uint64_t cutoff;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<HashSampleBindData>(keep_all, cutoff);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<HashSampleBindData>();
+		return keep_all == other.keep_all && cutoff == other.cutoff;
+	}
+};
+
+unique_ptr<FunctionData> HashSampleBind(ClientContext &context, ScalarFunction &bound_function,
+                                        vector<unique_ptr<Expression>> &arguments) {
+	if (!hash_vector_supports_type(arguments[0]->return_type)) {
+		throw BinderException("hash_sample: unsupported value type %s", arguments[0]->return_type.ToString());
+	}
+	auto fraction_value = GetConstantArgument(context, *arguments[1], "hash_sample", "fraction");
+	const auto fraction = fraction_value.DefaultCastAs(LogicalType::DOUBLE).GetValue<double>();
+	if (!(fraction >= 0 && fraction <= 1)) {
+		throw BinderException("hash_sample: fraction must be between 0 and 1, got %s", fraction_value.ToString());
+	}
+	if (fraction == 1) {
+		return make_uniq<HashSampleBindData>(true, 0);
+	}
+	// fraction * 2^64 is exact in double arithmetic and below 2^64 for any fraction < 1
+	return make_uniq<HashSampleBindData>(false, static_cast<uint64_t>(fraction * 18446744073709551616.0));
+}
+
+void HashSampleFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<HashSampleBindData>();
+	const auto row_count = args.size();
+
+	Vector hashes(LogicalType::UBIGINT, row_count);
+	if (args.ColumnCount() > 2) {
+		hash_vector_with_seed<uint64_t, HashAlgorithm::XXH3_64>(args.data[0], args.data[2], row_count, hashes);
+	} else {
+		hash_vector<uint64_t, HashAlgorithm::XXH3_64>(args.data[0], row_count, hashes);
+	}
+	auto hash_data = FlatVector::GetData<uint64_t>(hashes);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto keep = FlatVector::GetData<bool>(result);
+	FlatVector::SetValidity(result, FlatVector::Validity(hashes));
+	const auto cutoff = bind_data.cutoff;
+	if (bind_data.keep_all) {
+		for (idx_t i = 0; i < row_count; i++) {
+			keep[i] = true;
+		}
+	} else {
+		// NULL rows compare garbage; their result is masked by the validity copied above
+		for (idx_t i = 0; i < row_count; i++) {
+			keep[i] = hash_data[i] < cutoff;
+		}
+	}
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+} // namespace
+
+void RegisterHashSampleFunctions(ExtensionLoader &loader) {
+	ScalarFunctionSet sample_set("hash_sample");
+	for (auto &arguments : {vector<LogicalType> {LogicalType::ANY, LogicalType::DOUBLE},
+	                        vector<LogicalType> {LogicalType::ANY, LogicalType::DOUBLE, LogicalType::UBIGINT}}) {
+		ScalarFunction sample(arguments, LogicalType::BOOLEAN, HashSampleFunction, HashSampleBind);
+		// Expressions that can throw are not pushed into table scans
+		sample.errors = FunctionErrors::CANNOT_ERROR;
+		sample_set.AddFunction(sample);
+	}
+	CreateScalarFunctionInfo sample_info(sample_set);
+	sample_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::DOUBLE, LogicalType::UBIGINT},
+	     /* parameter_names */ {"value", "fraction", "seed"},
+	     /* description */
+	     "Deterministic sampling predicate: true for a fraction of the distinct values, those whose seeded xxh3_64 "
+	     "hash is below fraction * 2^64. The same values are kept in every table, and DuckDB evaluates the filter "
+	     "inside the table scan",
+	     /* examples */ {"SELECT * FROM events WHERE hash_sample(user_id, 0.05)",
+	                     "SELECT * FROM events WHERE hash_sample(user_id, 0.01, 42)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(sample_info);
+}
+
+} // namespace duckdb
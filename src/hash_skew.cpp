@@ -0,0 +1,255 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace duckdb {
+
+namespace {
+
+// Partition skew analysis.
+//
+// hash_skew(value, n [, algo]) counts the values per bucket with exactly the mapping of hash_bucket(value, n, algo),
+// floor(hash * n / 2^64), and summarizes the histogram: the largest bucket relative to the mean, the Gini coefficient
+// of the bucket sizes (0 when all buckets are equal, approaching 1 when one bucket holds everything) and the heaviest
+// buckets. Every thread fills its own histogram; combine adds them element-wise.
+static constexpr int64_t HASH_SKEW_MAX_BUCKETS = int64_t(1) << 20;
+static constexpr idx_t HASH_SKEW_HEAVIEST = 10;
+
+struct HashSkewBindData : public FunctionData {
+	HashSkewBindData(const HashAlgorithm algorithm_p, const uint64_t bucket_count_p)
+	    : algorithm(algorithm_p), bucket_count(bucket_count_p) {
+	}
+
+	HashAlgorithm algorithm;
+	uint64_t bucket_count;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<HashSkewBindData>(algorithm, bucket_count);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<HashSkewBindData>();
+		return algorithm == other.algorithm && bucket_count == other.bucket_count;
+	}
+};
+
+struct HashSkewState {
+	//! Rows per bucket; allocated on the first non-NULL value
+	vector<uint64_t> *counts;
+};
+
+struct HashSkewOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.counts = nullptr;
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		if (!source.counts) {
+			return;
+		}
+		if (!target.counts) {
+			target.counts = new vector<uint64_t>(*source.counts);
+			return;
+		}
+		auto &target_counts = *target.counts;
+		auto &source_counts = *source.counts;
+		for (idx_t i = 0; i < target_counts.size(); i++) {
+			target_counts[i] += source_counts[i];
+		}
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
+		if (state.counts) {
+			delete state.counts;
+			state.counts = nullptr;
+		}
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+void HashSkewUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vector,
+                    idx_t count) {
+	auto &bind_data = aggr_input_data.bind_data->Cast<HashSkewBindData>();
+	const auto n = bind_data.bucket_count;
+
+	Vector hashes(LogicalType::UBIGINT, count);
+	hash_vector_64(bind_data.algorithm, inputs[0], count, hashes);
+	auto hash_data = FlatVector::GetData<uint64_t>(hashes);
+	auto &hash_validity = FlatVector::Validity(hashes);
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<HashSkewState *>(sdata);
+	for (idx_t i = 0; i < count; i++) {
+		if (!hash_validity.RowIsValid(i)) {
+			continue;
+		}
+		auto &state = *states[sdata.sel->get_index(i)];
+		if (!state.counts) {
+			state.counts = new vector<uint64_t>(n, 0);
+		}
+		(*state.counts)[hash_reduce_range(hash_data[i], n)]++;
+	}
+}
+
+struct HashSkewSummary {
+	uint64_t rows = 0;
+	uint64_t empty_buckets = 0;
+	double max_mean_ratio = 0;
+	double gini = 0;
+	//! Heaviest non-empty buckets, largest first
+	vector<idx_t> heaviest;
+};
+
+HashSkewSummary SummarizeHashSkew(const vector<uint64_t> &counts) {
+	HashSkewSummary summary;
+	const auto n = counts.size();
+	uint64_t max_count = 0;
+	for (auto count : counts) {
+		summary.rows += count;
+		summary.empty_buckets += count == 0;
+		max_count = MaxValue(max_count, count);
+	}
+	summary.max_mean_ratio =
+	    static_cast<double>(max_count) * static_cast<double>(n) / static_cast<double>(summary.rows);
+
+	// Gini = 2 * sum(i * c_i) / (n * sum(c_i)) - (n + 1) / n, over the counts sorted ascending and i = 1..n
+	auto sorted = counts;
+	std::sort(sorted.begin(), sorted.end());
+	double weighted_sum = 0;
+	for (idx_t i = 0; i < n; i++) {
+		weighted_sum += static_cast<double>(i + 1) * static_cast<double>(sorted[i]);
+	}
+	summary.gini = 2 * weighted_sum / (static_cast<double>(n) * static_cast<double>(summary.rows)) -
+	               static_cast<double>(n + 1) / static_cast<double>(n);
+	summary.gini = MaxValue(summary.gini, 0.0);
+
+	summary.heaviest.resize(n);
+	std::iota(summary.heaviest.begin(), summary.heaviest.end(), idx_t(0));
+	const auto heaviest_count = MinValue(HASH_SKEW_HEAVIEST, n);
+	std::partial_sort(summary.heaviest.begin(), summary.heaviest.begin() + heaviest_count, summary.heaviest.end(),
+	                  [&](idx_t a, idx_t b) { return counts[a] != counts[b] ? counts[a] > counts[b] : a < b; });
+	summary.heaviest.resize(heaviest_count);
+	while (!summary.heaviest.empty() && counts[summary.heaviest.back()] == 0) {
+		summary.heaviest.pop_back();
+	}
+	return summary;
+}
+
+void HashSkewFinalize(Vector &state_vector, AggregateInputData &aggr_input_data, Vector &result, idx_t count,
+                      idx_t offset) {
+	auto &bind_data = aggr_input_data.bind_data->Cast<HashSkewBindData>();
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<HashSkewState *>(sdata);
+
+	auto &fields = StructVector::GetEntries(result);
+	auto buckets_data = FlatVector::GetData<int64_t>(*fields[0]);
+	auto rows_data = FlatVector::GetData<uint64_t>(*fields[1]);
+	auto empty_data = FlatVector::GetData<uint64_t>(*fields[2]);
+	auto ratio_data = FlatVector::GetData<double>(*fields[3]);
+	auto gini_data = FlatVector::GetData<double>(*fields[4]);
+	auto &heaviest_vector = *fields[5];
+	auto list_entries = FlatVector::GetData<list_entry_t>(heaviest_vector);
+
+	auto list_size = ListVector::GetListSize(heaviest_vector);
+	for (idx_t i = 0; i < count; i++) {
+		auto &state = *states[sdata.sel->get_index(i)];
+		const auto rid = i + offset;
+		if (!state.counts) {
+			FlatVector::SetNull(result, rid, true);
+			continue;
+		}
+		auto summary = SummarizeHashSkew(*state.counts);
+		buckets_data[rid] = static_cast<int64_t>(bind_data.bucket_count);
+		rows_data[rid] = summary.rows;
+		empty_data[rid] = summary.empty_buckets;
+		ratio_data[rid] = summary.max_mean_ratio;
+		gini_data[rid] = summary.gini;
+
+		ListVector::Reserve(heaviest_vector, list_size + summary.heaviest.size());
+		auto &bucket_fields = StructVector::GetEntries(ListVector::GetEntry(heaviest_vector));
+		auto bucket_data = FlatVector::GetData<int64_t>(*bucket_fields[0]);
+		auto bucket_count_data = FlatVector::GetData<uint64_t>(*bucket_fields[1]);
+		list_entries[rid].offset = list_size;
+		list_entries[rid].length = summary.heaviest.size();
+		for (auto bucket : summary.heaviest) {
+			bucket_data[list_size] = static_cast<int64_t>(bucket);
+			bucket_count_data[list_size] = (*state.counts)[bucket];
+			list_size++;
+		}
+	}
+	ListVector::SetListSize(heaviest_vector, list_size);
+	result.Verify(count);
+}
+
+unique_ptr<FunctionData> HashSkewBind(ClientContext &context, AggregateFunction &function,
+                                      vector<unique_ptr<Expression>> &arguments) {
+	auto &value_type = arguments[0]->return_type;
+	if (!hash_vector_supports_type(value_type)) {
+		throw BinderException("hash_skew: unsupported value type %s", value_type.ToString());
+	}
+	auto n = GetConstantArgument(context, *arguments[1], "hash_skew", "n").GetValue<int64_t>();
+	if (n < 1 || n > HASH_SKEW_MAX_BUCKETS) {
+		throw BinderException("hash_skew: bucket count must be between 1 and %d, got %d", HASH_SKEW_MAX_BUCKETS, n);
+	}
+	auto algorithm = HashAlgorithm::XXH3_64;
+	if (arguments.size() > 2) {
+		auto algo = GetConstantArgument(context, *arguments[2], "hash_skew", "algo");
+		algorithm = hash_algorithm_64_from_name("hash_skew", StringValue::Get(algo));
+		Function::EraseArgument(function, arguments, 2);
+	}
+	function.arguments[0] = value_type;
+	Function::EraseArgument(function, arguments, 1);
+	return make_uniq<HashSkewBindData>(algorithm, static_cast<uint64_t>(n));
+}
+
+} // namespace
+
+void RegisterHashSkewFunctions(ExtensionLoader &loader) {
+	const auto bucket_type = LogicalType::STRUCT({{"bucket", LogicalType::BIGINT}, {"count", LogicalType::UBIGINT}});
+	const auto summary_type = LogicalType::STRUCT({{"buckets", LogicalType::BIGINT},
+	                                               {"rows", LogicalType::UBIGINT},
+	                                               {"empty_buckets", LogicalType::UBIGINT},
+	                                               {"max_mean_ratio", LogicalType::DOUBLE},
+	                                               {"gini", LogicalType::DOUBLE},
+	                                               {"heaviest", LogicalType::LIST(bucket_type)}});
+	AggregateFunctionSet skew_set("hash_skew");
+	for (auto &arguments : {vector<LogicalType> {LogicalType::ANY, LogicalType::BIGINT},
+	                        vector<LogicalType> {LogicalType::ANY, LogicalType::BIGINT, LogicalType::VARCHAR}}) {
+		AggregateFunction skew(
+		    arguments, summary_type, AggregateFunction::StateSize<HashSkewState>,
+		    AggregateFunction::StateInitialize<HashSkewState, HashSkewOperation>, HashSkewUpdate,
+		    AggregateFunction::StateCombine<HashSkewState, HashSkewOperation>, HashSkewFinalize, nullptr, HashSkewBind,
+		    AggregateFunction::StateDestroy<HashSkewState, HashSkewOperation>);
+		skew.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+		skew_set.AddFunction(skew);
+	}
+	CreateAggregateFunctionInfo skew_info(skew_set);
+	skew_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::BIGINT, LogicalType::VARCHAR},
+	     /* parameter_names */ {"value", "n", "algo"},
+	     /* description */
+	     "Predicts partition skew: counts the values per bucket exactly as hash_bucket(value, n, algo) assigns them "
+	     "and returns the row count, empty buckets, max/mean bucket size ratio, Gini coefficient of the bucket sizes "
+	     "and the 10 heaviest non-empty buckets",
+	     /* examples */ {"hash_skew(customer_id, 256)", "hash_skew(customer_id, 256, 'rapidhash').max_mean_ratio"},
+	     /* categories */ {"hash", "aggregate"}});
+	loader.RegisterFunction(skew_info);
+}
+
+} // namespace duckdb
@@ -5,189 +5,12 @@
 #include "duckdb/function/scalar_function.hpp"
 #include <duckdb/parser/parsed_data/create_scalar_function_info.hpp>
 #include "duckdb/common/types/string_type.hpp"
-#include "xxhash.h"
-#include "rapidhash.h"
-#include "MurmurHash3.h"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
 #include "query_farm_telemetry.hpp"
 namespace duckdb {
 
 namespace {
-// Hash algorithm enumeration for template specialization
-enum class HashAlgorithm {
-	XXH32,
-	XXH64,
-	XXH3_64,
-	XXH3_128,
-	RAPIDHASH,
-	//	RAPIDHASH_MICRO,
-	//	RAPIDHASH_NANO,
-	MURMURHASH3_32,
-	MURMURHASH3_128,
-	MURMURHASH3_X64_128
-};
-
-// Type trait to map hash algorithm to its seed type
-template <HashAlgorithm Algorithm>
-struct hash_seed_type {
-	// Default case - will cause compilation error for unmapped algorithms
-	using type = void;
-};
-
-// Specializations for each algorithm
-template <>
-struct hash_seed_type<HashAlgorithm::XXH32> {
-	using type = uint32_t; // XXH32 uses 32-bit seed
-};
-
-template <>
-struct hash_seed_type<HashAlgorithm::XXH64> {
-	using type = uint64_t; // XXH64 uses 64-bit seed
-};
-
-template <>
-struct hash_seed_type<HashAlgorithm::XXH3_64> {
-	using type = uint64_t; // XXH3_64 uses 64-bit seed
-};
-
-template <>
-struct hash_seed_type<HashAlgorithm::XXH3_128> {
-	using type = uint64_t; // XXH3_128 uses 64-bit seed
-};
-
-template <>
-struct hash_seed_type<HashAlgorithm::RAPIDHASH> {
-	using type = uint64_t; // RapidHash typically uses 64-bit seed
-};
-
-// template <>
-// struct hash_seed_type<HashAlgorithm::RAPIDHASH_MICRO> {
-// 	using type = uint64_t; // RapidHash micro variant
-// };
-
-// template <>
-// struct hash_seed_type<HashAlgorithm::RAPIDHASH_NANO> {
-// 	using type = uint64_t; // RapidHash nano variant
-// };
-
-template <>
-struct hash_seed_type<HashAlgorithm::MURMURHASH3_32> {
-	using type = uint32_t; // MurmurHash3 32-bit uses 32-bit seed
-};
-
-template <>
-struct hash_seed_type<HashAlgorithm::MURMURHASH3_128> {
-	using type = uint32_t; // MurmurHash3 128-bit uses 32-bit seed
-};
-
-template <>
-struct hash_seed_type<HashAlgorithm::MURMURHASH3_X64_128> {
-	using type = uint32_t; // MurmurHash3 x64 128-bit uses 32-bit seed
-};
-
-template <HashAlgorithm Algorithm>
-using hash_seed_type_t = typename hash_seed_type<Algorithm>::type;
-
-template <typename TargetType, typename ResultType, HashAlgorithm Algorithm>
-inline void hash_fixed_type_generic_with_seed(const UnifiedVectorFormat &input_vdata, const idx_t row_count,
-                                              const Vector &input_vector, const UnifiedVectorFormat &seed_vdata,
-                                              const Vector &seed_vector, ValidityMask &result_validity,
-                                              ResultType *results) {
-	auto inputs = FlatVector::GetData<TargetType>(input_vector);
-
-	using SeedType = hash_seed_type_t<Algorithm>;
-	auto seeds = FlatVector::GetData<SeedType>(seed_vector);
-
-	for (idx_t i = 0; i < row_count; i++) {
-		if (!input_vdata.validity.RowIsValid(i) || !seed_vdata.validity.RowIsValid(i)) {
-			result_validity.SetInvalid(i);
-			continue;
-		}
-
-		const auto input_idx = input_vdata.sel->get_index(i);
-		const auto seed_value = seeds[seed_vdata.sel->get_index(i)];
-
-		if constexpr (Algorithm == HashAlgorithm::XXH32) {
-			// 32-bit hash using XXH32
-			results[i] = XXH32(&inputs[input_idx], sizeof(TargetType), seed_value);
-		} else if constexpr (Algorithm == HashAlgorithm::XXH64) {
-			// 64-bit hash using XXH64
-			results[i] = XXH64(&inputs[input_idx], sizeof(TargetType), seed_value);
-		} else if constexpr (Algorithm == HashAlgorithm::XXH3_64) {
-			// 64-bit hash using XXH3
-			results[i] = XXH3_64bits_withSeed(&inputs[input_idx], sizeof(TargetType), seed_value);
-		} else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH) {
-			// 64-bit hash using RapidHash
-			results[i] = rapidhash_withSeed(&inputs[input_idx], sizeof(TargetType), seed_value);
-			// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_MICRO) {
-			// 	// 64-bit hash using RapidHash Micro
-			// 	results[i] = rapidhashMicro_withSeed(&inputs[input_idx], sizeof(TargetType), seed_value);
-			// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_NANO) {
-			// 	// 64-bit hash using RapidHash Nano
-			// 	results[i] = rapidhashNano_withSeed(&inputs[input_idx], sizeof(TargetType), seed_value);
-		} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_32) {
-			// 32-bit hash using MurmurHash3
-			MurmurHash3_x86_32(&inputs[input_idx], sizeof(TargetType), seed_value, &results[i]);
-		} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_128) {
-			// 128-bit hash using MurmurHash3
-			MurmurHash3_x86_128(&inputs[input_idx], sizeof(TargetType), seed_value, &results[i]);
-		} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_X64_128) {
-			// 128-bit hash using MurmurHash3 x64
-			MurmurHash3_x64_128(&inputs[input_idx], sizeof(TargetType), seed_value, &results[i]);
-		} else if constexpr (Algorithm == HashAlgorithm::XXH3_128) {
-			// 128-bit hash
-			XXH128_hash_t hash128 = XXH3_128bits_withSeed(&inputs[input_idx], sizeof(TargetType), seed_value);
-			results[i] = uhugeint_t {hash128.low64, hash128.high64};
-		}
-	}
-}
-
-// Template function for fixed-size types - now supports all hash algorithms
-template <typename TargetType, typename ResultType, HashAlgorithm Algorithm>
-inline void hash_fixed_type_generic(const UnifiedVectorFormat &vdata, const idx_t row_count, const Vector &vector,
-                                    ValidityMask &result_validity, ResultType *results) {
-	auto inputs = FlatVector::GetData<TargetType>(vector);
-
-	for (idx_t i = 0; i < row_count; i++) {
-		if (!vdata.validity.RowIsValid(i)) {
-			result_validity.SetInvalid(i);
-			continue;
-		}
-
-		const auto input_idx = vdata.sel->get_index(i);
-		if constexpr (Algorithm == HashAlgorithm::XXH32) {
-			// 32-bit hash using XXH32
-			results[i] = XXH32(&inputs[input_idx], sizeof(TargetType), 0);
-		} else if constexpr (Algorithm == HashAlgorithm::XXH64) {
-			// 64-bit hash using XXH64
-			results[i] = XXH64(&inputs[input_idx], sizeof(TargetType), 0);
-		} else if constexpr (Algorithm == HashAlgorithm::XXH3_64) {
-			// 64-bit hash using XXH3
-			results[i] = XXH3_64bits(&inputs[input_idx], sizeof(TargetType));
-		} else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH) {
-			// 64-bit hash using RapidHash
-			results[i] = rapidhash(&inputs[input_idx], sizeof(TargetType));
-			// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_MICRO) {
-			// 	// 64-bit hash using RapidHash Micro
-			// 	results[i] = rapidhashMicro(&inputs[input_idx], sizeof(TargetType));
-			// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_NANO) {
-			// 	// 64-bit hash using RapidHash Nano
-			// 	results[i] = rapidhashNano(&inputs[input_idx], sizeof(TargetType));
-		} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_32) {
-			// 32-bit hash using MurmurHash3
-			MurmurHash3_x86_32(&inputs[input_idx], sizeof(TargetType), 0, &results[i]);
-		} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_128) {
-			// 128-bit hash using MurmurHash3
-			MurmurHash3_x86_128(&inputs[input_idx], sizeof(TargetType), 0, &results[i]);
-		} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_X64_128) {
-			// 128-bit hash using MurmurHash3 x64
-			MurmurHash3_x64_128(&inputs[input_idx], sizeof(TargetType), 0, &results[i]);
-		} else if constexpr (Algorithm == HashAlgorithm::XXH3_128) {
-			// 128-bit hash
-			XXH128_hash_t hash128 = XXH3_128bits(&inputs[input_idx], sizeof(TargetType));
-			results[i] = uhugeint_t {hash128.low64, hash128.high64};
-		}
-	}
-}
 
 // Generic hash function template
 template <typename ResultType, HashAlgorithm Algorithm>
@@ -201,130 +24,7 @@ inline void hashfunc_generic(DataChunk &args, ExpressionState &state, Vector &re
 		return;
 	}
 
-	UnifiedVectorFormat vdata;
-	input_vector.ToUnifiedFormat(row_count, vdata);
-
-	result.SetVectorType(VectorType::FLAT_VECTOR);
-	auto result_validity = FlatVector::Validity(result);
-	auto results = FlatVector::GetData<ResultType>(result);
-
-	const auto type_id = input_vector.GetType().id();
-
-	switch (type_id) {
-	case LogicalTypeId::BLOB:
-	case LogicalTypeId::VARCHAR: {
-		auto inputs = FlatVector::GetData<string_t>(input_vector);
-		for (idx_t i = 0; i < row_count; i++) {
-			if (!vdata.validity.RowIsValid(i)) {
-				result_validity.SetInvalid(i);
-				continue;
-			}
-			const auto &str = inputs[vdata.sel->get_index(i)];
-
-			if constexpr (Algorithm == HashAlgorithm::XXH32) {
-				// 32-bit hash using XXH32
-				results[i] = XXH32(str.GetData(), str.GetSize(), 0);
-			} else if constexpr (Algorithm == HashAlgorithm::XXH64) {
-				// 64-bit hash using XXH64
-				results[i] = XXH64(str.GetData(), str.GetSize(), 0);
-			} else if constexpr (Algorithm == HashAlgorithm::XXH3_64) {
-				results[i] = XXH3_64bits(str.GetData(), str.GetSize());
-			} else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH) {
-				results[i] = rapidhash(str.GetData(), str.GetSize());
-				// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_MICRO) {
-				// 	results[i] = rapidhashMicro(str.GetData(), str.GetSize());
-				// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_NANO) {
-				// 	results[i] = rapidhashNano(str.GetData(), str.GetSize());
-			} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_32) {
-				// 32-bit hash using MurmurHash3
-				MurmurHash3_x86_32(str.GetData(), str.GetSize(), 0, &results[i]);
-			} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_128) {
-				// 128-bit hash using MurmurHash3
-				MurmurHash3_x86_128(str.GetData(), str.GetSize(), 0, &results[i]);
-			} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_X64_128) {
-				// 128-bit hash using MurmurHash3 x64
-				MurmurHash3_x64_128(str.GetData(), str.GetSize(), 0, &results[i]);
-			} else if constexpr (Algorithm == HashAlgorithm::XXH3_128) {
-				// 128-bit hash
-				XXH128_hash_t hash128 = XXH3_128bits(str.GetData(), str.GetSize());
-				results[i] = uhugeint_t {hash128.low64, hash128.high64};
-			}
-		}
-		break;
-	}
-
-	case LogicalTypeId::HUGEINT:
-		hash_fixed_type_generic<hugeint_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                          results);
-		break;
-
-	case LogicalTypeId::UHUGEINT:
-		hash_fixed_type_generic<uhugeint_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                           results);
-		break;
-
-	case LogicalTypeId::USMALLINT:
-		hash_fixed_type_generic<uint16_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                         results);
-		break;
-
-	case LogicalTypeId::UINTEGER:
-		hash_fixed_type_generic<uint32_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                         results);
-		break;
-
-	case LogicalTypeId::INTEGER:
-		hash_fixed_type_generic<int32_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                        results);
-		break;
-
-	case LogicalTypeId::BIGINT:
-		hash_fixed_type_generic<int64_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                        results);
-		break;
-
-	case LogicalTypeId::UBIGINT:
-		hash_fixed_type_generic<uint64_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                         results);
-		break;
-
-	case LogicalTypeId::SMALLINT:
-		hash_fixed_type_generic<int16_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                        results);
-		break;
-
-	case LogicalTypeId::UTINYINT:
-		hash_fixed_type_generic<uint8_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                        results);
-		break;
-
-	case LogicalTypeId::TINYINT:
-		hash_fixed_type_generic<int8_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                       results);
-		break;
-
-	case LogicalTypeId::FLOAT:
-		hash_fixed_type_generic<float, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::DOUBLE:
-		hash_fixed_type_generic<double, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                       results);
-		break;
-
-	case LogicalTypeId::DATE:
-		hash_fixed_type_generic<uint32_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                         results);
-		break;
-
-	case LogicalTypeId::TIME:
-		hash_fixed_type_generic<uint64_t, ResultType, Algorithm>(vdata, row_count, input_vector, result_validity,
-		                                                         results);
-		break;
-
-	default:
-		throw NotImplementedException("Unsupported type for XXH hash: " + LogicalType(type_id).ToString());
-	}
+	hash_vector<ResultType, Algorithm>(input_vector, row_count, result);
 
 	// Optimize for single-row results
 	if (row_count == 1) {
@@ -344,143 +44,36 @@ inline void hashfunc_generic_with_seed(DataChunk &args, ExpressionState &state,
 		return;
 	}
 
-	UnifiedVectorFormat input_vdata;
-	input_vector.ToUnifiedFormat(row_count, input_vdata);
-
-	UnifiedVectorFormat seed_vdata;
-	seed_vector.ToUnifiedFormat(row_count, seed_vdata);
-
-	result.SetVectorType(VectorType::FLAT_VECTOR);
-	auto result_validity = FlatVector::Validity(result);
-	auto results = FlatVector::GetData<ResultType>(result);
-
-	const auto type_id = input_vector.GetType().id();
-
-	switch (type_id) {
-	case LogicalTypeId::BLOB:
-	case LogicalTypeId::VARCHAR: {
-		auto inputs = FlatVector::GetData<string_t>(input_vector);
+	hash_vector_with_seed<ResultType, Algorithm>(input_vector, seed_vector, row_count, result);
 
-		auto seeds = FlatVector::GetData<hash_seed_type_t<Algorithm>>(seed_vector);
-		for (idx_t i = 0; i < row_count; i++) {
-			if (!input_vdata.validity.RowIsValid(i) || !seed_vdata.validity.RowIsValid(i)) {
-				result_validity.SetInvalid(i);
-				continue;
-			}
-			const auto &str = inputs[input_vdata.sel->get_index(i)];
-
-			const auto seed_value = seeds[seed_vdata.sel->get_index(i)];
-
-			if constexpr (Algorithm == HashAlgorithm::XXH32) {
-				// 32-bit hash using XXH32
-				results[i] = XXH32(str.GetData(), str.GetSize(), seed_value);
-			} else if constexpr (Algorithm == HashAlgorithm::XXH64) {
-				// 64-bit hash using XXH64
-				results[i] = XXH64(str.GetData(), str.GetSize(), seed_value);
-			} else if constexpr (Algorithm == HashAlgorithm::XXH3_64) {
-				results[i] = XXH3_64bits_withSeed(str.GetData(), str.GetSize(), seed_value);
-			} else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH) {
-				results[i] = rapidhash_withSeed(str.GetData(), str.GetSize(), seed_value);
-				// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_MICRO) {
-				// 	results[i] = rapidhashMicro_withSeed(str.GetData(), str.GetSize(), seed_value);
-				// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_NANO) {
-				// 	results[i] = rapidhashNano_withSeed(str.GetData(), str.GetSize(), seed_value);
-			} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_32) {
-				// 32-bit hash using MurmurHash3
-				MurmurHash3_x86_32(str.GetData(), str.GetSize(), seed_value, &results[i]);
-			} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_128) {
-				// 128-bit hash using MurmurHash3
-				MurmurHash3_x86_128(str.GetData(), str.GetSize(), seed_value, &results[i]);
-			} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_X64_128) {
-				// 128-bit hash using MurmurHash3 x64
-				MurmurHash3_x64_128(str.GetData(), str.GetSize(), seed_value, &results[i]);
-			} else if constexpr (Algorithm == HashAlgorithm::XXH3_128) {
-				// 128-bit hash
-				XXH128_hash_t hash128 = XXH3_128bits_withSeed(str.GetData(), str.GetSize(), seed_value);
-				results[i] = uhugeint_t {hash128.low64, hash128.high64};
-			}
-		}
-		break;
+	// Optimize for single-row results
+	if (row_count == 1) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
 	}
+}
 
-	case LogicalTypeId::HUGEINT:
-		hash_fixed_type_generic_with_seed<hugeint_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::UHUGEINT:
-		hash_fixed_type_generic_with_seed<uhugeint_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::USMALLINT:
-		hash_fixed_type_generic_with_seed<uint16_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::UINTEGER:
-		hash_fixed_type_generic_with_seed<uint32_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::INTEGER:
-		hash_fixed_type_generic_with_seed<int32_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::BIGINT:
-		hash_fixed_type_generic_with_seed<int64_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::UBIGINT:
-		hash_fixed_type_generic_with_seed<uint64_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::SMALLINT:
-		hash_fixed_type_generic_with_seed<int16_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::UTINYINT:
-		hash_fixed_type_generic_with_seed<uint8_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::TINYINT:
-		hash_fixed_type_generic_with_seed<int8_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::FLOAT:
-		hash_fixed_type_generic_with_seed<float, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::DOUBLE:
-		hash_fixed_type_generic_with_seed<double, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::DATE:
-		hash_fixed_type_generic_with_seed<uint32_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
-
-	case LogicalTypeId::TIME:
-		hash_fixed_type_generic_with_seed<uint64_t, ResultType, Algorithm>(
-		    input_vdata, row_count, input_vector, seed_vdata, seed_vector, result_validity, results);
-		break;
+// Hash of a byte range of a VARCHAR or BLOB, read in place
+template <typename ResultType, HashAlgorithm Algorithm>
+inline void hashfunc_generic_range(DataChunk &args, ExpressionState &state, Vector &result) {
+	hash_vector_range<ResultType, Algorithm>(args.data[0], args.data[1], args.data[2], args.size(), result);
+}
 
-	default:
-		throw NotImplementedException("Unsupported type for XXH hash: " + LogicalType(type_id).ToString());
+// Adds the (value, offset, length) overloads to a hash function set
+void AddByteRangeOverloads(ScalarFunctionSet &set, const LogicalType &return_type, scalar_function_t function) {
+	for (auto &type : {LogicalType::VARCHAR, LogicalType::BLOB}) {
+		set.AddFunction(ScalarFunction({type, LogicalType::BIGINT, LogicalType::BIGINT}, return_type, function));
 	}
+}
 
-	// Optimize for single-row results
-	if (row_count == 1) {
-		result.SetVectorType(VectorType::CONSTANT_VECTOR);
-	}
+void AddByteRangeDescription(CreateScalarFunctionInfo &info, const string &name) {
+	info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::BIGINT, LogicalType::BIGINT},
+	     /* parameter_names */ {"value", "offset", "length"},
+	     /* description */
+	     "Computes " + name + " of the length bytes starting at byte offset (0-based) of a VARCHAR or BLOB, reading "
+	     "the range in place instead of copying a substring. The range is clamped to the value",
+	     /* examples */ {name + "(content, 0, 4096)"},
+	     /* categories */ {"hash"}});
 }
 
 // 32-bit hash function using XXH32
@@ -543,26 +136,25 @@ inline void hashfunc_XXH3_128_hex(DataChunk &args, ExpressionState &state, Vecto
 	input_vector.ToUnifiedFormat(row_count, vdata);
 
 	result.SetVectorType(VectorType::FLAT_VECTOR);
-	auto result_validity = FlatVector::Validity(result);
+	auto &result_validity = FlatVector::Validity(result);
 
 	const auto type_id = input_vector.GetType().id();
 
 	switch (type_id) {
 	case LogicalTypeId::BLOB:
 	case LogicalTypeId::VARCHAR: {
-		auto inputs = FlatVector::GetData<string_t>(input_vector);
+		auto inputs = UnifiedVectorFormat::GetData<string_t>(vdata);
 		for (idx_t i = 0; i < row_count; i++) {
-			if (!vdata.validity.RowIsValid(i)) {
+			const auto input_idx = vdata.sel->get_index(i);
+			if (!vdata.validity.RowIsValid(input_idx)) {
 				result_validity.SetInvalid(i);
 				continue;
 			}
-			const auto &str = inputs[vdata.sel->get_index(i)];
+			const auto &str = inputs[input_idx];
 			XXH128_hash_t hash128 = XXH3_128bits(str.GetData(), str.GetSize());
 			// Canonical format: low64 hex || high64 hex (matches Python xxhash.hexdigest())
 			char hex_buf[33];
-			snprintf(hex_buf, sizeof(hex_buf), "%016llx%016llx",
-			         static_cast<unsigned long long>(hash128.low64),
-			         static_cast<unsigned long long>(hash128.high64));
+			hash_xxh128_hex(hash128, hex_buf);
 			FlatVector::GetData<string_t>(result)[i] = StringVector::AddString(result, hex_buf, 32);
 		}
 		break;
@@ -590,27 +182,41 @@ inline void hashfunc_XXH3_128_hex_with_seed(DataChunk &args, ExpressionState &st
 	seed_vector.ToUnifiedFormat(row_count, seed_vdata);
 
 	result.SetVectorType(VectorType::FLAT_VECTOR);
-	auto result_validity = FlatVector::Validity(result);
+	auto &result_validity = FlatVector::Validity(result);
 
-	auto inputs = FlatVector::GetData<string_t>(input_vector);
-	auto seeds = FlatVector::GetData<uint64_t>(seed_vector);
+	auto inputs = UnifiedVectorFormat::GetData<string_t>(input_vdata);
+	auto seeds = UnifiedVectorFormat::GetData<uint64_t>(seed_vdata);
 
 	for (idx_t i = 0; i < row_count; i++) {
-		if (!input_vdata.validity.RowIsValid(i) || !seed_vdata.validity.RowIsValid(i)) {
+		const auto input_idx = input_vdata.sel->get_index(i);
+		const auto seed_idx = seed_vdata.sel->get_index(i);
+		if (!input_vdata.validity.RowIsValid(input_idx) || !seed_vdata.validity.RowIsValid(seed_idx)) {
 			result_validity.SetInvalid(i);
 			continue;
 		}
-		const auto &str = inputs[input_vdata.sel->get_index(i)];
-		const auto seed_value = seeds[seed_vdata.sel->get_index(i)];
+		const auto &str = inputs[input_idx];
+		const auto seed_value = seeds[seed_idx];
 		XXH128_hash_t hash128 = XXH3_128bits_withSeed(str.GetData(), str.GetSize(), seed_value);
 		char hex_buf[33];
-		snprintf(hex_buf, sizeof(hex_buf), "%016llx%016llx",
-		         static_cast<unsigned long long>(hash128.low64),
-		         static_cast<unsigned long long>(hash128.high64));
+		hash_xxh128_hex(hash128, hex_buf);
 		FlatVector::GetData<string_t>(result)[i] = StringVector::AddString(result, hex_buf, 32);
 	}
 }
 
+// 128-bit hash of a byte range as canonical hex VARCHAR
+inline void hashfunc_XXH3_128_hex_range(DataChunk &args, ExpressionState &state, Vector &result) {
+	TernaryExecutor::Execute<string_t, int64_t, int64_t, string_t>(
+	    args.data[0], args.data[1], args.data[2], result, args.size(),
+	    [&](const string_t &value, const int64_t offset, const int64_t length) {
+		    const char *data;
+		    idx_t size;
+		    hash_byte_range(value, offset, length, data, size);
+		    char hex_buf[33];
+		    hash_xxh128_hex(XXH3_128bits(data, size), hex_buf);
+		    return StringVector::AddString(result, hex_buf, 32);
+	    });
+}
+
 inline void hashfunc_rapidhash(DataChunk &args, ExpressionState &state, Vector &result) {
 	hashfunc_generic<uint64_t, HashAlgorithm::RAPIDHASH>(args, state, result);
 }
@@ -659,6 +265,21 @@ inline void hashfunc_MurmurHash3_X64_128_with_seed(DataChunk &args, ExpressionSt
 	hashfunc_generic_with_seed<uhugeint_t, HashAlgorithm::MURMURHASH3_X64_128>(args, state, result);
 }
 
+// 32-bit CRC (ISO-HDLC, as in gzip and zlib)
+inline void hashfunc_CRC32(DataChunk &args, ExpressionState &state, Vector &result) {
+	hashfunc_generic<uint32_t, HashAlgorithm::CRC32>(args, state, result);
+}
+
+// 32-bit CRC (Castagnoli)
+inline void hashfunc_CRC32C(DataChunk &args, ExpressionState &state, Vector &result) {
+	hashfunc_generic<uint32_t, HashAlgorithm::CRC32C>(args, state, result);
+}
+
+// 64-bit CRC (XZ)
+inline void hashfunc_CRC64(DataChunk &args, ExpressionState &state, Vector &result) {
+	hashfunc_generic<uint64_t, HashAlgorithm::CRC64>(args, state, result);
+}
+
 } // namespace
 
 static void LoadInternal(ExtensionLoader &loader) {
@@ -668,6 +289,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	xxh32_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UINTEGER, hashfunc_XXH32));
 	xxh32_set.AddFunction(
 	    ScalarFunction({LogicalType::ANY, LogicalType::UINTEGER}, LogicalType::UINTEGER, hashfunc_XXH32_with_seed));
+	AddByteRangeOverloads(xxh32_set, LogicalType::UINTEGER, hashfunc_generic_range<uint32_t, HashAlgorithm::XXH32>);
 	CreateScalarFunctionInfo xxh32_info(xxh32_set);
 	xxh32_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -681,6 +303,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     /* description */ "Computes a 32-bit xxHash (XXH32) non-cryptographic hash of the input with a seed",
 	     /* examples */ {"xxh32('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(xxh32_info, "xxh32");
 	loader.RegisterFunction(xxh32_info);
 
 	// XXH64 - 64-bit xxHash
@@ -688,6 +311,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	xxh64_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UBIGINT, hashfunc_XXH64));
 	xxh64_set.AddFunction(
 	    ScalarFunction({LogicalType::ANY, LogicalType::UBIGINT}, LogicalType::UBIGINT, hashfunc_XXH64_with_seed));
+	AddByteRangeOverloads(xxh64_set, LogicalType::UBIGINT, hashfunc_generic_range<uint64_t, HashAlgorithm::XXH64>);
 	CreateScalarFunctionInfo xxh64_info(xxh64_set);
 	xxh64_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -701,6 +325,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     /* description */ "Computes a 64-bit xxHash (XXH64) non-cryptographic hash of the input with a seed",
 	     /* examples */ {"xxh64('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(xxh64_info, "xxh64");
 	loader.RegisterFunction(xxh64_info);
 
 	// XXH3_64 - 64-bit xxHash3 (faster than XXH64 for short inputs)
@@ -708,6 +333,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	xxh3_64_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UBIGINT, hashfunc_XXH3_64));
 	xxh3_64_set.AddFunction(
 	    ScalarFunction({LogicalType::ANY, LogicalType::UBIGINT}, LogicalType::UBIGINT, hashfunc_XXH3_64_with_seed));
+	AddByteRangeOverloads(xxh3_64_set, LogicalType::UBIGINT, hashfunc_generic_range<uint64_t, HashAlgorithm::XXH3_64>);
 	CreateScalarFunctionInfo xxh3_64_info(xxh3_64_set);
 	xxh3_64_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -722,6 +348,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     /* description */ "Computes a 64-bit xxHash3 (XXH3_64) non-cryptographic hash of the input with a seed",
 	     /* examples */ {"xxh3_64('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(xxh3_64_info, "xxh3_64");
 	loader.RegisterFunction(xxh3_64_info);
 
 	// XXH3_128 - 128-bit xxHash3
@@ -729,6 +356,8 @@ static void LoadInternal(ExtensionLoader &loader) {
 	xxh3_128_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UHUGEINT, hashfunc_XXH3_128));
 	xxh3_128_set.AddFunction(
 	    ScalarFunction({LogicalType::ANY, LogicalType::UBIGINT}, LogicalType::UHUGEINT, hashfunc_XXH3_128_with_seed));
+	AddByteRangeOverloads(xxh3_128_set, LogicalType::UHUGEINT,
+	                      hashfunc_generic_range<uhugeint_t, HashAlgorithm::XXH3_128>);
 	CreateScalarFunctionInfo xxh3_128_info(xxh3_128_set);
 	xxh3_128_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -742,6 +371,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     /* description */ "Computes a 128-bit xxHash3 (XXH3_128) non-cryptographic hash of the input with a seed",
 	     /* examples */ {"xxh3_128('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(xxh3_128_info, "xxh3_128");
 	loader.RegisterFunction(xxh3_128_info);
 
 	// XXH3_128_hex - 128-bit xxHash3 as canonical hex string
@@ -752,6 +382,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	    ScalarFunction({LogicalType::VARCHAR, LogicalType::UBIGINT}, LogicalType::VARCHAR, hashfunc_XXH3_128_hex_with_seed));
 	xxh3_128_hex_set.AddFunction(
 	    ScalarFunction({LogicalType::BLOB, LogicalType::UBIGINT}, LogicalType::VARCHAR, hashfunc_XXH3_128_hex_with_seed));
+	AddByteRangeOverloads(xxh3_128_hex_set, LogicalType::VARCHAR, hashfunc_XXH3_128_hex_range);
 	CreateScalarFunctionInfo xxh3_128_hex_info(xxh3_128_hex_set);
 	xxh3_128_hex_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::VARCHAR},
@@ -767,6 +398,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	                       "hex string in canonical byte order",
 	     /* examples */ {"xxh3_128_hex('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(xxh3_128_hex_info, "xxh3_128_hex");
 	loader.RegisterFunction(xxh3_128_hex_info);
 
 	// RapidHash - fast 64-bit hash
@@ -774,6 +406,8 @@ static void LoadInternal(ExtensionLoader &loader) {
 	rapidhash_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UBIGINT, hashfunc_rapidhash));
 	rapidhash_set.AddFunction(
 	    ScalarFunction({LogicalType::ANY, LogicalType::UBIGINT}, LogicalType::UBIGINT, hashfunc_rapidhash_with_seed));
+	AddByteRangeOverloads(rapidhash_set, LogicalType::UBIGINT,
+	                      hashfunc_generic_range<uint64_t, HashAlgorithm::RAPIDHASH>);
 	CreateScalarFunctionInfo rapidhash_info(rapidhash_set);
 	rapidhash_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -788,6 +422,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     /* description */ "Computes a 64-bit RapidHash non-cryptographic hash of the input with a seed",
 	     /* examples */ {"rapidhash('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(rapidhash_info, "rapidhash");
 	loader.RegisterFunction(rapidhash_info);
 
 	// MurmurHash3 32-bit
@@ -795,6 +430,8 @@ static void LoadInternal(ExtensionLoader &loader) {
 	murmurhash3_32_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UINTEGER, hashfunc_MurmurHash3_32));
 	murmurhash3_32_set.AddFunction(ScalarFunction({LogicalType::ANY, LogicalType::UINTEGER}, LogicalType::UINTEGER,
 	                                              hashfunc_MurmurHash3_32_with_seed));
+	AddByteRangeOverloads(murmurhash3_32_set, LogicalType::UINTEGER,
+	                      hashfunc_generic_range<uint32_t, HashAlgorithm::MURMURHASH3_32>);
 	CreateScalarFunctionInfo murmurhash3_32_info(murmurhash3_32_set);
 	murmurhash3_32_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -808,6 +445,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     /* description */ "Computes a 32-bit MurmurHash3 non-cryptographic hash of the input with a seed",
 	     /* examples */ {"murmurhash3_32('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(murmurhash3_32_info, "murmurhash3_32");
 	loader.RegisterFunction(murmurhash3_32_info);
 
 	// MurmurHash3 128-bit (x86 variant)
@@ -816,6 +454,8 @@ static void LoadInternal(ExtensionLoader &loader) {
 	    ScalarFunction({LogicalType::ANY}, LogicalType::UHUGEINT, hashfunc_MurmurHash3_128));
 	murmurhash3_128_set.AddFunction(ScalarFunction({LogicalType::ANY, LogicalType::UINTEGER}, LogicalType::UHUGEINT,
 	                                               hashfunc_MurmurHash3_128_with_seed));
+	AddByteRangeOverloads(murmurhash3_128_set, LogicalType::UHUGEINT,
+	                      hashfunc_generic_range<uhugeint_t, HashAlgorithm::MURMURHASH3_128>);
 	CreateScalarFunctionInfo murmurhash3_128_info(murmurhash3_128_set);
 	murmurhash3_128_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -829,6 +469,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     /* description */ "Computes a 128-bit MurmurHash3 (x86 variant) non-cryptographic hash of the input with a seed",
 	     /* examples */ {"murmurhash3_128('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(murmurhash3_128_info, "murmurhash3_128");
 	loader.RegisterFunction(murmurhash3_128_info);
 
 	// MurmurHash3 128-bit (x64 variant - optimized for 64-bit platforms)
@@ -837,6 +478,8 @@ static void LoadInternal(ExtensionLoader &loader) {
 	    ScalarFunction({LogicalType::ANY}, LogicalType::UHUGEINT, hashfunc_MurmurHash3_X64_128));
 	murmurhash3_x64_128_set.AddFunction(ScalarFunction({LogicalType::ANY, LogicalType::UINTEGER}, LogicalType::UHUGEINT,
 	                                                   hashfunc_MurmurHash3_X64_128_with_seed));
+	AddByteRangeOverloads(murmurhash3_x64_128_set, LogicalType::UHUGEINT,
+	                      hashfunc_generic_range<uhugeint_t, HashAlgorithm::MURMURHASH3_X64_128>);
 	CreateScalarFunctionInfo murmurhash3_x64_128_info(murmurhash3_x64_128_set);
 	murmurhash3_x64_128_info.descriptions.push_back(
 	    {/* parameter_types */ {LogicalType::ANY},
@@ -853,8 +496,75 @@ static void LoadInternal(ExtensionLoader &loader) {
 	     "Computes a 128-bit MurmurHash3 (x64 variant) non-cryptographic hash of the input with a seed",
 	     /* examples */ {"murmurhash3_x64_128('hello', 42)"},
 	     /* categories */ {"hash"}});
+	AddByteRangeDescription(murmurhash3_x64_128_info, "murmurhash3_x64_128");
 	loader.RegisterFunction(murmurhash3_x64_128_info);
 
+	// CRC-32 - gzip, zlib, PNG
+	ScalarFunctionSet crc32_set("crc32");
+	crc32_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UINTEGER, hashfunc_CRC32));
+	AddByteRangeOverloads(crc32_set, LogicalType::UINTEGER, hashfunc_generic_range<uint32_t, HashAlgorithm::CRC32>);
+	CreateScalarFunctionInfo crc32_info(crc32_set);
+	crc32_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY},
+	     /* parameter_names */ {"value"},
+	     /* description */ "Computes the CRC-32 checksum used by gzip, zlib and PNG (ISO-HDLC polynomial 0x04C11DB7)",
+	     /* examples */ {"crc32('hello')"},
+	     /* categories */ {"hash"}});
+	AddByteRangeDescription(crc32_info, "crc32");
+	loader.RegisterFunction(crc32_info);
+
+	// CRC-32C - iSCSI, ext4, SCTP
+	ScalarFunctionSet crc32c_set("crc32c");
+	crc32c_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UINTEGER, hashfunc_CRC32C));
+	AddByteRangeOverloads(crc32c_set, LogicalType::UINTEGER, hashfunc_generic_range<uint32_t, HashAlgorithm::CRC32C>);
+	CreateScalarFunctionInfo crc32c_info(crc32c_set);
+	crc32c_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY},
+	     /* parameter_names */ {"value"},
+	     /* description */
+	     "Computes the CRC-32C checksum used by iSCSI, ext4 and SCTP (Castagnoli polynomial 0x1EDC6F41)",
+	     /* examples */ {"crc32c('hello')"},
+	     /* categories */ {"hash"}});
+	AddByteRangeDescription(crc32c_info, "crc32c");
+	loader.RegisterFunction(crc32c_info);
+
+	// CRC-64 - xz
+	ScalarFunctionSet crc64_set("crc64");
+	crc64_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UBIGINT, hashfunc_CRC64));
+	AddByteRangeOverloads(crc64_set, LogicalType::UBIGINT, hashfunc_generic_range<uint64_t, HashAlgorithm::CRC64>);
+	CreateScalarFunctionInfo crc64_info(crc64_set);
+	crc64_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY},
+	     /* parameter_names */ {"value"},
+	     /* description */ "Computes the CRC-64 checksum used by xz (ECMA-182 polynomial, reflected)",
+	     /* examples */ {"crc64('hello')"},
+	     /* categories */ {"hash"}});
+	AddByteRangeDescription(crc64_info, "crc64");
+	loader.RegisterFunction(crc64_info);
+
+	RegisterCountMinSketchFunctions(loader);
+	RegisterSpaceSavingFunctions(loader);
+	RegisterThetaSketchFunctions(loader);
+	RegisterFuseFilterFunctions(loader);
+	RegisterCountDistinctHashedFunctions(loader);
+	RegisterFileHashFunctions(loader);
+	RegisterContentDefinedChunkingFunctions(loader);
+	RegisterMerkleDigestFunctions(loader);
+	RegisterStreamingStateFunctions(loader);
+	RegisterTreeHashFunctions(loader);
+	RegisterCRCFunctions(loader);
+	RegisterJSONHashFunctions(loader);
+	RegisterHashFingerprintFunctions(loader);
+	RegisterHashBucketFunctions(loader);
+	RegisterRendezvousHashFunctions(loader);
+	RegisterMaglevFunctions(loader);
+	RegisterKetamaFunctions(loader);
+	RegisterHashSampleFunctions(loader);
+	RegisterHashRandomFunctions(loader);
+	RegisterHashPermuteFunctions(loader);
+	RegisterHashMixFunctions(loader);
+	RegisterHashSkewFunctions(loader);
+
 	QueryFarmSendTelemetry(loader, "hashfuncs", "2025120402");
 }
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+
+namespace duckdb {
+
+// Evaluate a function argument that must be a non-NULL constant at bind time (sketch sizes, k, bucket counts, ...)
+inline Value GetConstantArgument(ClientContext &context, Expression &expr, const string &function_name,
+                                 const string &argument_name) {
+	if (!expr.IsFoldable()) {
+		throw BinderException("%s: argument '%s' must be a constant", function_name, argument_name);
+	}
+	auto value = ExpressionExecutor::EvaluateScalar(context, expr);
+	if (value.IsNull()) {
+		throw BinderException("%s: argument '%s' cannot be NULL", function_name, argument_name);
+	}
+	return value;
+}
+
+} // namespace duckdb
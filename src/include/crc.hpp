@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace duckdb {
+
+// CRC-32 (ISO-HDLC: gzip, zlib, PNG), CRC-32C (Castagnoli: iSCSI, ext4, SCTP) and CRC-64 (XZ, the reflected
+// ECMA-182 polynomial). Each *_update continues a finished CRC with more data the way zlib's crc32() does, so
+// crc32_update(crc32_update(0, a), b) is the CRC of a followed by b. The x86-64 kernels are selected at runtime.
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+uint32_t crc32c_update(uint32_t crc, const void *data, size_t len);
+uint64_t crc64_update(uint64_t crc, const void *data, size_t len);
+
+// CRC of a followed by b, given the CRCs of a and b and the length of b in bytes
+uint32_t crc32_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b);
+uint32_t crc32c_combine(uint32_t crc_a, uint32_t crc_b, uint64_t len_b);
+uint64_t crc64_combine(uint64_t crc_a, uint64_t crc_b, uint64_t len_b);
+
+} // namespace duckdb
@@ -0,0 +1,715 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/vector_operations/ternary_executor.hpp"
+#include "xxhash.h"
+#include "rapidhash.h"
+#include "MurmurHash3.h"
+#include "crc.hpp"
+
+namespace duckdb {
+
+// Hash algorithm enumeration for template specialization
+enum class HashAlgorithm {
+	XXH32,
+	XXH64,
+	XXH3_64,
+	XXH3_128,
+	RAPIDHASH,
+	//	RAPIDHASH_MICRO,
+	//	RAPIDHASH_NANO,
+	MURMURHASH3_32,
+	MURMURHASH3_128,
+	MURMURHASH3_X64_128,
+	CRC32,
+	CRC32C,
+	CRC64
+};
+
+// Type trait to map hash algorithm to its seed type
+template <HashAlgorithm Algorithm>
+struct hash_seed_type {
+	// Default case - will cause compilation error for unmapped algorithms
+	using type = void;
+};
+
+// Specializations for each algorithm
+template <>
+struct hash_seed_type<HashAlgorithm::XXH32> {
+	using type = uint32_t; // XXH32 uses 32-bit seed
+};
+
+template <>
+struct hash_seed_type<HashAlgorithm::XXH64> {
+	using type = uint64_t; // XXH64 uses 64-bit seed
+};
+
+template <>
+struct hash_seed_type<HashAlgorithm::XXH3_64> {
+	using type = uint64_t; // XXH3_64 uses 64-bit seed
+};
+
+template <>
+struct hash_seed_type<HashAlgorithm::XXH3_128> {
+	using type = uint64_t; // XXH3_128 uses 64-bit seed
+};
+
+template <>
+struct hash_seed_type<HashAlgorithm::RAPIDHASH> {
+	using type = uint64_t; // RapidHash typically uses 64-bit seed
+};
+
+// template <>
+// struct hash_seed_type<HashAlgorithm::RAPIDHASH_MICRO> {
+// 	using type = uint64_t; // RapidHash micro variant
+// };
+
+// template <>
+// struct hash_seed_type<HashAlgorithm::RAPIDHASH_NANO> {
+// 	using type = uint64_t; // RapidHash nano variant
+// };
+
+template <>
+struct hash_seed_type<HashAlgorithm::MURMURHASH3_32> {
+	using type = uint32_t; // MurmurHash3 32-bit uses 32-bit seed
+};
+
+template <>
+struct hash_seed_type<HashAlgorithm::MURMURHASH3_128> {
+	using type = uint32_t; // MurmurHash3 128-bit uses 32-bit seed
+};
+
+template <>
+struct hash_seed_type<HashAlgorithm::MURMURHASH3_X64_128> {
+	using type = uint32_t; // MurmurHash3 x64 128-bit uses 32-bit seed
+};
+
+template <HashAlgorithm Algorithm>
+using hash_seed_type_t = typename hash_seed_type<Algorithm>::type;
+
+// MurmurHash3 64-bit finalizer. A cheap bijective remix used to derive independent bits from an existing hash.
+inline uint64_t hash_fmix64(uint64_t k) {
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+// SplitMix64 output function (Stafford's Mix13), a bijective 64-bit mixer with stronger avalanche than fmix64
+inline uint64_t hash_splitmix64_mix(uint64_t z) {
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+// SplitMix64 generator step: advances state by the golden gamma and returns its mixed value. Expands one seed into a
+// sequence of well-distributed 64-bit keys.
+inline uint64_t hash_splitmix64(uint64_t &state) {
+	return hash_splitmix64_mix(state += 0x9e3779b97f4a7c15ULL);
+}
+
+// Lemire's multiply-high range reduction: maps a 64-bit hash onto [0, n) as floor(hash * n / 2^64), without a
+// division. The buckets differ in size by at most one hash value, so for n below 2^32 the bias is under 2^-32.
+inline uint64_t hash_reduce_range(const uint64_t hash, const uint64_t n) {
+#if defined(__SIZEOF_INT128__)
+	return static_cast<uint64_t>((static_cast<__uint128_t>(hash) * n) >> 64);
+#else
+	const uint64_t hash_lo = hash & 0xffffffffULL;
+	const uint64_t hash_hi = hash >> 32;
+	const uint64_t n_lo = n & 0xffffffffULL;
+	const uint64_t n_hi = n >> 32;
+	const uint64_t lo_lo = hash_lo * n_lo;
+	const uint64_t hi_lo = hash_hi * n_lo;
+	const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffULL) + hash_lo * n_hi;
+	return (hi_lo >> 32) + (cross >> 32) + hash_hi * n_hi;
+#endif
+}
+
+// Lamping and Veach's jump consistent hash: maps a 64-bit key to a bucket in [0, n) such that growing n to n + 1
+// moves only the keys that land in the new bucket. Takes O(ln n) steps of a linear congruential generator.
+inline uint64_t hash_jump_bucket(uint64_t key, const uint64_t n) {
+	int64_t bucket = -1;
+	int64_t next = 0;
+	while (next < static_cast<int64_t>(n)) {
+		bucket = next;
+		key = key * 2862933555777941757ULL + 1;
+		next = static_cast<int64_t>(static_cast<double>(bucket + 1) *
+		                            (static_cast<double>(int64_t(1) << 31) / static_cast<double>((key >> 33) + 1)));
+	}
+	return static_cast<uint64_t>(bucket);
+}
+
+// Wrapping (modulo 2^128) addition and subtraction of 128-bit digests, for order-independent digest sums.
+// uhugeint_t's own operators throw on overflow.
+inline void hash_digest_add(uhugeint_t &target, const uhugeint_t &value) {
+	const auto lower = target.lower + value.lower;
+	target.upper += value.upper + (lower < target.lower ? 1 : 0);
+	target.lower = lower;
+}
+
+inline void hash_digest_subtract(uhugeint_t &target, const uhugeint_t &value) {
+	const auto borrow = target.lower < value.lower ? 1 : 0;
+	target.lower -= value.lower;
+	target.upper -= value.upper + borrow;
+}
+
+// Render a 128-bit xxHash digest as 32 lowercase hex characters, low64 followed by high64 (the xxh3_128_hex format)
+inline void hash_xxh128_hex(const XXH128_hash_t &hash, char (&buffer)[33]) {
+	snprintf(buffer, sizeof(buffer), "%016llx%016llx", static_cast<unsigned long long>(hash.low64),
+	         static_cast<unsigned long long>(hash.high64));
+}
+
+// Hash a contiguous byte range with the algorithm's default (unseeded) variant
+template <typename ResultType, HashAlgorithm Algorithm>
+inline void hash_bytes(const void *data, const size_t len, ResultType &result) {
+	if constexpr (Algorithm == HashAlgorithm::XXH32) {
+		// 32-bit hash using XXH32
+		result = XXH32(data, len, 0);
+	} else if constexpr (Algorithm == HashAlgorithm::XXH64) {
+		// 64-bit hash using XXH64
+		result = XXH64(data, len, 0);
+	} else if constexpr (Algorithm == HashAlgorithm::XXH3_64) {
+		// 64-bit hash using XXH3
+		result = XXH3_64bits(data, len);
+	} else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH) {
+		// 64-bit hash using RapidHash
+		result = rapidhash(data, len);
+		// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_MICRO) {
+		// 	// 64-bit hash using RapidHash Micro
+		// 	result = rapidhashMicro(data, len);
+		// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_NANO) {
+		// 	// 64-bit hash using RapidHash Nano
+		// 	result = rapidhashNano(data, len);
+	} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_32) {
+		// 32-bit hash using MurmurHash3
+		MurmurHash3_x86_32(data, static_cast<int>(len), 0, &result);
+	} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_128) {
+		// 128-bit hash using MurmurHash3
+		MurmurHash3_x86_128(data, static_cast<int>(len), 0, &result);
+	} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_X64_128) {
+		// 128-bit hash using MurmurHash3 x64
+		MurmurHash3_x64_128(data, static_cast<int>(len), 0, &result);
+	} else if constexpr (Algorithm == HashAlgorithm::XXH3_128) {
+		// 128-bit hash
+		XXH128_hash_t hash128 = XXH3_128bits(data, len);
+		result = uhugeint_t {hash128.low64, hash128.high64};
+	} else if constexpr (Algorithm == HashAlgorithm::CRC32) {
+		// 32-bit CRC (ISO-HDLC, as in gzip and zlib)
+		result = crc32_update(0, data, len);
+	} else if constexpr (Algorithm == HashAlgorithm::CRC32C) {
+		// 32-bit CRC (Castagnoli)
+		result = crc32c_update(0, data, len);
+	} else if constexpr (Algorithm == HashAlgorithm::CRC64) {
+		// 64-bit CRC (XZ)
+		result = crc64_update(0, data, len);
+	}
+}
+
+// Hash a contiguous byte range with an explicit seed
+template <typename ResultType, HashAlgorithm Algorithm>
+inline void hash_bytes_with_seed(const void *data, const size_t len, const hash_seed_type_t<Algorithm> seed_value,
+                                 ResultType &result) {
+	if constexpr (Algorithm == HashAlgorithm::XXH32) {
+		// 32-bit hash using XXH32
+		result = XXH32(data, len, seed_value);
+	} else if constexpr (Algorithm == HashAlgorithm::XXH64) {
+		// 64-bit hash using XXH64
+		result = XXH64(data, len, seed_value);
+	} else if constexpr (Algorithm == HashAlgorithm::XXH3_64) {
+		// 64-bit hash using XXH3
+		result = XXH3_64bits_withSeed(data, len, seed_value);
+	} else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH) {
+		// 64-bit hash using RapidHash
+		result = rapidhash_withSeed(data, len, seed_value);
+		// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_MICRO) {
+		// 	// 64-bit hash using RapidHash Micro
+		// 	result = rapidhashMicro_withSeed(data, len, seed_value);
+		// } else if constexpr (Algorithm == HashAlgorithm::RAPIDHASH_NANO) {
+		// 	// 64-bit hash using RapidHash Nano
+		// 	result = rapidhashNano_withSeed(data, len, seed_value);
+	} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_32) {
+		// 32-bit hash using MurmurHash3
+		MurmurHash3_x86_32(data, static_cast<int>(len), seed_value, &result);
+	} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_128) {
+		// 128-bit hash using MurmurHash3
+		MurmurHash3_x86_128(data, static_cast<int>(len), seed_value, &result);
+	} else if constexpr (Algorithm == HashAlgorithm::MURMURHASH3_X64_128) {
+		// 128-bit hash using MurmurHash3 x64
+		MurmurHash3_x64_128(data, static_cast<int>(len), seed_value, &result);
+	} else if constexpr (Algorithm == HashAlgorithm::XXH3_128) {
+		// 128-bit hash
+		XXH128_hash_t hash128 = XXH3_128bits_withSeed(data, len, seed_value);
+		result = uhugeint_t {hash128.low64, hash128.high64};
+	}
+}
+
+template <typename TargetType, typename ResultType, HashAlgorithm Algorithm>
+inline void hash_fixed_type_generic_with_seed(const UnifiedVectorFormat &input_vdata, const idx_t row_count,
+                                              const UnifiedVectorFormat &seed_vdata, ValidityMask &result_validity,
+                                              ResultType *results) {
+	auto inputs = UnifiedVectorFormat::GetData<TargetType>(input_vdata);
+
+	using SeedType = hash_seed_type_t<Algorithm>;
+	auto seeds = UnifiedVectorFormat::GetData<SeedType>(seed_vdata);
+
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto input_idx = input_vdata.sel->get_index(i);
+		const auto seed_idx = seed_vdata.sel->get_index(i);
+		if (!input_vdata.validity.RowIsValid(input_idx) || !seed_vdata.validity.RowIsValid(seed_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		hash_bytes_with_seed<ResultType, Algorithm>(&inputs[input_idx], sizeof(TargetType), seeds[seed_idx],
+		                                            results[i]);
+	}
+}
+
+// Template function for fixed-size types - now supports all hash algorithms
+template <typename TargetType, typename ResultType, HashAlgorithm Algorithm>
+inline void hash_fixed_type_generic(const UnifiedVectorFormat &vdata, const idx_t row_count,
+                                    ValidityMask &result_validity, ResultType *results) {
+	auto inputs = UnifiedVectorFormat::GetData<TargetType>(vdata);
+
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto input_idx = vdata.sel->get_index(i);
+		if (!vdata.validity.RowIsValid(input_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		hash_bytes<ResultType, Algorithm>(&inputs[input_idx], sizeof(TargetType), results[i]);
+	}
+}
+
+// Whether hash_vector can hash values of this type; lets aggregates reject unsupported inputs at bind time
+inline bool hash_vector_supports_type(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::BLOB:
+	case LogicalTypeId::VARCHAR:
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::UHUGEINT:
+	case LogicalTypeId::USMALLINT:
+	case LogicalTypeId::UINTEGER:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::UBIGINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::UTINYINT:
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Hash every row of input_vector into a flat result vector of ResultType. NULL rows become NULL.
+// This is the shared per-row kernel used by the scalar functions and by the sketch aggregates.
+template <typename ResultType, HashAlgorithm Algorithm>
+inline void hash_vector(Vector &input_vector, const idx_t row_count, Vector &result) {
+	UnifiedVectorFormat vdata;
+	input_vector.ToUnifiedFormat(row_count, vdata);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto &result_validity = FlatVector::Validity(result);
+	auto results = FlatVector::GetData<ResultType>(result);
+
+	const auto type_id = input_vector.GetType().id();
+
+	switch (type_id) {
+	case LogicalTypeId::BLOB:
+	case LogicalTypeId::VARCHAR: {
+		auto inputs = UnifiedVectorFormat::GetData<string_t>(vdata);
+		for (idx_t i = 0; i < row_count; i++) {
+			const auto input_idx = vdata.sel->get_index(i);
+			if (!vdata.validity.RowIsValid(input_idx)) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			const auto &str = inputs[input_idx];
+			hash_bytes<ResultType, Algorithm>(str.GetData(), str.GetSize(), results[i]);
+		}
+		break;
+	}
+
+	case LogicalTypeId::HUGEINT:
+		hash_fixed_type_generic<hugeint_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::UHUGEINT:
+		hash_fixed_type_generic<uhugeint_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::USMALLINT:
+		hash_fixed_type_generic<uint16_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::UINTEGER:
+		hash_fixed_type_generic<uint32_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::INTEGER:
+		hash_fixed_type_generic<int32_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::BIGINT:
+		hash_fixed_type_generic<int64_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::UBIGINT:
+		hash_fixed_type_generic<uint64_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::SMALLINT:
+		hash_fixed_type_generic<int16_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::UTINYINT:
+		hash_fixed_type_generic<uint8_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::TINYINT:
+		hash_fixed_type_generic<int8_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::FLOAT:
+		hash_fixed_type_generic<float, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::DOUBLE:
+		hash_fixed_type_generic<double, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::DATE:
+		hash_fixed_type_generic<uint32_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	case LogicalTypeId::TIME:
+		hash_fixed_type_generic<uint64_t, ResultType, Algorithm>(vdata, row_count, result_validity, results);
+		break;
+
+	default:
+		throw NotImplementedException("Unsupported type for XXH hash: " + LogicalType(type_id).ToString());
+	}
+}
+
+// 64-bit algorithms that functions taking an algo name (hash_bucket, ...) select at bind time
+inline HashAlgorithm hash_algorithm_64_from_name(const string &function_name, const string &name) {
+	const auto lower = StringUtil::Lower(name);
+	if (lower == "xxh3_64") {
+		return HashAlgorithm::XXH3_64;
+	} else if (lower == "xxh64") {
+		return HashAlgorithm::XXH64;
+	} else if (lower == "rapidhash") {
+		return HashAlgorithm::RAPIDHASH;
+	}
+	throw BinderException("%s: unsupported algo '%s', expected one of xxh3_64, xxh64, rapidhash", function_name,
+	                      name);
+}
+
+// hash_vector for a 64-bit algorithm chosen at bind time
+inline void hash_vector_64(const HashAlgorithm algorithm, Vector &input_vector, const idx_t row_count,
+                           Vector &result) {
+	switch (algorithm) {
+	case HashAlgorithm::XXH3_64:
+		hash_vector<uint64_t, HashAlgorithm::XXH3_64>(input_vector, row_count, result);
+		break;
+	case HashAlgorithm::XXH64:
+		hash_vector<uint64_t, HashAlgorithm::XXH64>(input_vector, row_count, result);
+		break;
+	case HashAlgorithm::RAPIDHASH:
+		hash_vector<uint64_t, HashAlgorithm::RAPIDHASH>(input_vector, row_count, result);
+		break;
+	default:
+		throw InternalException("hash_vector_64: not a 64-bit algorithm");
+	}
+}
+
+// Byte range [offset, offset + length) of a string or BLOB, clamped to the value like substring. The range points
+// into the value's own data, so hashing the prefix of a large BLOB neither copies it nor reads the rest.
+inline void hash_byte_range(const string_t &value, const int64_t offset, const int64_t length, const char *&data,
+                            idx_t &size) {
+	if (offset < 0 || length < 0) {
+		throw InvalidInputException("hash byte range: offset and length must be non-negative");
+	}
+	const idx_t value_size = value.GetSize();
+	const auto start = MinValue<idx_t>(static_cast<idx_t>(offset), value_size);
+	data = value.GetData() + start;
+	size = MinValue<idx_t>(static_cast<idx_t>(length), value_size - start);
+}
+
+// Hash a byte range of every VARCHAR or BLOB row. NULL values, offsets or lengths become NULL.
+template <typename ResultType, HashAlgorithm Algorithm>
+inline void hash_vector_range(Vector &input_vector, Vector &offset_vector, Vector &length_vector, const idx_t row_count,
+                              Vector &result) {
+	TernaryExecutor::Execute<string_t, int64_t, int64_t, ResultType>(
+	    input_vector, offset_vector, length_vector, result, row_count,
+	    [](const string_t &value, const int64_t offset, const int64_t length) {
+		    const char *data;
+		    idx_t size;
+		    hash_byte_range(value, offset, length, data, size);
+		    ResultType hash;
+		    hash_bytes<ResultType, Algorithm>(data, size, hash);
+		    return hash;
+	    });
+}
+
+// Seeded counterpart of hash_vector; seed_vector must already be of the algorithm's seed type
+template <typename ResultType, HashAlgorithm Algorithm>
+inline void hash_vector_with_seed(Vector &input_vector, Vector &seed_vector, const idx_t row_count, Vector &result) {
+	UnifiedVectorFormat input_vdata;
+	input_vector.ToUnifiedFormat(row_count, input_vdata);
+
+	UnifiedVectorFormat seed_vdata;
+	seed_vector.ToUnifiedFormat(row_count, seed_vdata);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto &result_validity = FlatVector::Validity(result);
+	auto results = FlatVector::GetData<ResultType>(result);
+
+	const auto type_id = input_vector.GetType().id();
+
+	switch (type_id) {
+	case LogicalTypeId::BLOB:
+	case LogicalTypeId::VARCHAR: {
+		auto inputs = UnifiedVectorFormat::GetData<string_t>(input_vdata);
+		auto seeds = UnifiedVectorFormat::GetData<hash_seed_type_t<Algorithm>>(seed_vdata);
+		for (idx_t i = 0; i < row_count; i++) {
+			const auto input_idx = input_vdata.sel->get_index(i);
+			const auto seed_idx = seed_vdata.sel->get_index(i);
+			if (!input_vdata.validity.RowIsValid(input_idx) || !seed_vdata.validity.RowIsValid(seed_idx)) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			const auto &str = inputs[input_idx];
+			hash_bytes_with_seed<ResultType, Algorithm>(str.GetData(), str.GetSize(), seeds[seed_idx], results[i]);
+		}
+		break;
+	}
+
+	case LogicalTypeId::HUGEINT:
+		hash_fixed_type_generic_with_seed<hugeint_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                    result_validity, results);
+		break;
+
+	case LogicalTypeId::UHUGEINT:
+		hash_fixed_type_generic_with_seed<uhugeint_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                     result_validity, results);
+		break;
+
+	case LogicalTypeId::USMALLINT:
+		hash_fixed_type_generic_with_seed<uint16_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                   result_validity, results);
+		break;
+
+	case LogicalTypeId::UINTEGER:
+		hash_fixed_type_generic_with_seed<uint32_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                   result_validity, results);
+		break;
+
+	case LogicalTypeId::INTEGER:
+		hash_fixed_type_generic_with_seed<int32_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                  result_validity, results);
+		break;
+
+	case LogicalTypeId::BIGINT:
+		hash_fixed_type_generic_with_seed<int64_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                  result_validity, results);
+		break;
+
+	case LogicalTypeId::UBIGINT:
+		hash_fixed_type_generic_with_seed<uint64_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                   result_validity, results);
+		break;
+
+	case LogicalTypeId::SMALLINT:
+		hash_fixed_type_generic_with_seed<int16_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                  result_validity, results);
+		break;
+
+	case LogicalTypeId::UTINYINT:
+		hash_fixed_type_generic_with_seed<uint8_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                  result_validity, results);
+		break;
+
+	case LogicalTypeId::TINYINT:
+		hash_fixed_type_generic_with_seed<int8_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                 result_validity, results);
+		break;
+
+	case LogicalTypeId::FLOAT:
+		hash_fixed_type_generic_with_seed<float, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                result_validity, results);
+		break;
+
+	case LogicalTypeId::DOUBLE:
+		hash_fixed_type_generic_with_seed<double, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                 result_validity, results);
+		break;
+
+	case LogicalTypeId::DATE:
+		hash_fixed_type_generic_with_seed<uint32_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                   result_validity, results);
+		break;
+
+	case LogicalTypeId::TIME:
+		hash_fixed_type_generic_with_seed<uint64_t, ResultType, Algorithm>(input_vdata, row_count, seed_vdata,
+		                                                                   result_validity, results);
+		break;
+
+	default:
+		throw NotImplementedException("Unsupported type for XXH hash: " + LogicalType(type_id).ToString());
+	}
+}
+
+// Row hashing: whether every field of a row (or the value itself) can be hashed by hash_row_xxh3_128. Values are
+// hashed by physical type, so any fixed-width type (BOOLEAN, DECIMAL, TIMESTAMP, UUID, INTERVAL, ...) and any string
+// type is supported; STRUCT fields are hashed recursively. Lists and arrays are not supported.
+inline bool hash_row_supports_type(const LogicalType &type) {
+	switch (type.InternalType()) {
+	case PhysicalType::BOOL:
+	case PhysicalType::UINT8:
+	case PhysicalType::INT8:
+	case PhysicalType::UINT16:
+	case PhysicalType::INT16:
+	case PhysicalType::UINT32:
+	case PhysicalType::INT32:
+	case PhysicalType::UINT64:
+	case PhysicalType::INT64:
+	case PhysicalType::UINT128:
+	case PhysicalType::INT128:
+	case PhysicalType::FLOAT:
+	case PhysicalType::DOUBLE:
+	case PhysicalType::INTERVAL:
+	case PhysicalType::VARCHAR:
+		return true;
+	case PhysicalType::STRUCT:
+		for (auto &child : StructType::GetChildTypes(type)) {
+			if (!hash_row_supports_type(child.second)) {
+				return false;
+			}
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+inline void hash_struct_rows_xxh3_128(Vector &input, const idx_t row_count, ValidityMask &result_validity,
+                                      uhugeint_t *results);
+
+// Hash the values of one column into 128-bit digests by physical type; NULL rows are marked invalid and left untouched
+inline void hash_column_xxh3_128(Vector &input, const idx_t row_count, ValidityMask &result_validity,
+                                 uhugeint_t *results) {
+	if (input.GetType().InternalType() == PhysicalType::STRUCT) {
+		hash_struct_rows_xxh3_128(input, row_count, result_validity, results);
+		return;
+	}
+	UnifiedVectorFormat vdata;
+	input.ToUnifiedFormat(row_count, vdata);
+	constexpr auto XXH3_128 = HashAlgorithm::XXH3_128;
+	switch (input.GetType().InternalType()) {
+	case PhysicalType::BOOL:
+		hash_fixed_type_generic<bool, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::UINT8:
+		hash_fixed_type_generic<uint8_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::INT8:
+		hash_fixed_type_generic<int8_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::UINT16:
+		hash_fixed_type_generic<uint16_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::INT16:
+		hash_fixed_type_generic<int16_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::UINT32:
+		hash_fixed_type_generic<uint32_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::INT32:
+		hash_fixed_type_generic<int32_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::UINT64:
+		hash_fixed_type_generic<uint64_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::INT64:
+		hash_fixed_type_generic<int64_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::UINT128:
+		hash_fixed_type_generic<uhugeint_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::INT128:
+		hash_fixed_type_generic<hugeint_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::FLOAT:
+		hash_fixed_type_generic<float, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::DOUBLE:
+		hash_fixed_type_generic<double, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::INTERVAL:
+		hash_fixed_type_generic<interval_t, uhugeint_t, XXH3_128>(vdata, row_count, result_validity, results);
+		break;
+	case PhysicalType::VARCHAR: {
+		auto inputs = UnifiedVectorFormat::GetData<string_t>(vdata);
+		for (idx_t i = 0; i < row_count; i++) {
+			const auto input_idx = vdata.sel->get_index(i);
+			if (!vdata.validity.RowIsValid(input_idx)) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			hash_bytes<uhugeint_t, XXH3_128>(inputs[input_idx].GetData(), inputs[input_idx].GetSize(), results[i]);
+		}
+		break;
+	}
+	default:
+		throw NotImplementedException("Unsupported type for row hash: " + input.GetType().ToString());
+	}
+}
+
+// Hash every row of a STRUCT vector. Each field is hashed on its own and the row digest is xxh3_128 over the field
+// digests (all-zero for NULL fields) followed by a bitmap of the NULL fields, so field order, values and NULLs all
+// change the result. A NULL struct row becomes NULL.
+inline void hash_struct_rows_xxh3_128(Vector &input, const idx_t row_count, ValidityMask &result_validity,
+                                      uhugeint_t *results) {
+	input.Flatten(row_count);
+	auto &fields = StructVector::GetEntries(input);
+	const idx_t field_count = fields.size();
+	const idx_t null_bytes = (field_count + 7) / 8;
+
+	vector<uhugeint_t> field_digests(field_count * row_count, uhugeint_t(0));
+	vector<ValidityMask> field_validity;
+	for (idx_t f = 0; f < field_count; f++) {
+		field_validity.emplace_back(row_count);
+		hash_column_xxh3_128(*fields[f], row_count, field_validity[f], field_digests.data() + f * row_count);
+	}
+
+	auto &struct_validity = FlatVector::Validity(input);
+	vector<data_t> row_buffer(field_count * 2 * sizeof(uint64_t) + null_bytes);
+	for (idx_t i = 0; i < row_count; i++) {
+		if (!struct_validity.RowIsValid(i)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		auto ptr = row_buffer.data();
+		memset(ptr + field_count * 2 * sizeof(uint64_t), 0, null_bytes);
+		for (idx_t f = 0; f < field_count; f++) {
+			const bool valid = field_validity[f].RowIsValid(i);
+			const auto &digest = field_digests[f * row_count + i];
+			Store<uint64_t>(valid ? digest.lower : 0, ptr + f * 2 * sizeof(uint64_t));
+			Store<uint64_t>(valid ? digest.upper : 0, ptr + f * 2 * sizeof(uint64_t) + sizeof(uint64_t));
+			if (!valid) {
+				ptr[field_count * 2 * sizeof(uint64_t) + f / 8] |= static_cast<data_t>(1 << (f % 8));
+			}
+		}
+		hash_bytes<uhugeint_t, HashAlgorithm::XXH3_128>(ptr, row_buffer.size(), results[i]);
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// Registration entry points for function families that live in their own translation unit
+void RegisterCountMinSketchFunctions(ExtensionLoader &loader);
+void RegisterSpaceSavingFunctions(ExtensionLoader &loader);
+void RegisterThetaSketchFunctions(ExtensionLoader &loader);
+void RegisterFuseFilterFunctions(ExtensionLoader &loader);
+void RegisterCountDistinctHashedFunctions(ExtensionLoader &loader);
+void RegisterFileHashFunctions(ExtensionLoader &loader);
+void RegisterContentDefinedChunkingFunctions(ExtensionLoader &loader);
+void RegisterMerkleDigestFunctions(ExtensionLoader &loader);
+void RegisterStreamingStateFunctions(ExtensionLoader &loader);
+void RegisterTreeHashFunctions(ExtensionLoader &loader);
+void RegisterCRCFunctions(ExtensionLoader &loader);
+void RegisterJSONHashFunctions(ExtensionLoader &loader);
+void RegisterHashFingerprintFunctions(ExtensionLoader &loader);
+void RegisterHashBucketFunctions(ExtensionLoader &loader);
+void RegisterRendezvousHashFunctions(ExtensionLoader &loader);
+void RegisterMaglevFunctions(ExtensionLoader &loader);
+void RegisterKetamaFunctions(ExtensionLoader &loader);
+void RegisterHashSampleFunctions(ExtensionLoader &loader);
+void RegisterHashRandomFunctions(ExtensionLoader &loader);
+void RegisterHashPermuteFunctions(ExtensionLoader &loader);
+void RegisterHashMixFunctions(ExtensionLoader &loader);
+void RegisterHashSkewFunctions(ExtensionLoader &loader);
+
+} // namespace duckdb
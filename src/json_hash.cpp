@@ -0,0 +1,309 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+#include "yyjson.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace duckdb_yyjson; // NOLINT
+
+namespace duckdb {
+
+namespace {
+
+// Canonical JSON hashing.
+//
+// json_hash parses a document with yyjson and walks it in canonical order, feeding a compact tagged encoding of each
+// token straight into the hash state, so semantically equal documents hash equal without building a normalized
+// string first. Whitespace, object key order, string escapes (\u0041 is A) and number spelling (1, 1.0 and 1e0
+// are the same number) do not affect the hash; array order, types and values do.
+//
+// Encoding, integers little-endian:
+//   null 'n', true 't', false 'f'
+//   integral number 'i', sign byte (1 if negative), 8-byte magnitude
+//   other number 'd', 8-byte IEEE 754 double
+//   string 's', 8-byte byte length, UTF-8 bytes
+//   array '[', 8-byte element count, elements
+//   object '{', 8-byte member count, members sorted by key bytes: 8-byte key length, key bytes, value
+// Duplicate keys are all hashed, in document order.
+static constexpr idx_t JSON_HASH_MAX_DEPTH = 1000;
+static constexpr idx_t JSON_HASH_BUFFER_SIZE = 1024;
+
+enum class JSONHashAlgorithm : uint8_t { XXH64, XXH3_64, XXH3_128 };
+
+JSONHashAlgorithm ParseJSONHashAlgorithm(const string &name) {
+	const auto lower = StringUtil::Lower(name);
+	if (lower == "xxh64") {
+		return JSONHashAlgorithm::XXH64;
+	} else if (lower == "xxh3_64") {
+		return JSONHashAlgorithm::XXH3_64;
+	} else if (lower == "xxh3_128") {
+		return JSONHashAlgorithm::XXH3_128;
+	}
+	throw BinderException("json_hash: unsupported algo '%s', expected one of xxh64, xxh3_64, xxh3_128", name);
+}
+
+// Walks documents and hashes their canonical encoding. Tokens are gathered in a small buffer so the streaming hash
+// is updated in blocks rather than once per token.
+class CanonicalJSONHasher {
+public:
+	explicit CanonicalJSONHasher(const JSONHashAlgorithm algorithm_p) : algorithm(algorithm_p) {
+		if (algorithm == JSONHashAlgorithm::XXH64) {
+			xxh64_state = XXH64_createState();
+		} else {
+			xxh3_state = XXH3_createState();
+		}
+		if (!xxh64_state && !xxh3_state) {
+			throw OutOfMemoryException("failed to allocate xxHash streaming state");
+		}
+	}
+
+	~CanonicalJSONHasher() {
+		XXH64_freeState(xxh64_state);
+		XXH3_freeState(xxh3_state);
+	}
+
+	CanonicalJSONHasher(const CanonicalJSONHasher &) = delete;
+	CanonicalJSONHasher &operator=(const CanonicalJSONHasher &) = delete;
+
+	void Hash(const string_t &input) {
+		yyjson_read_err error;
+		auto doc = yyjson_read_opts(const_cast<char *>(input.GetData()), input.GetSize(), YYJSON_READ_NOFLAG, nullptr,
+		                            &error);
+		if (!doc) {
+			throw InvalidInputException("json_hash: malformed JSON at byte %d: %s", static_cast<int64_t>(error.pos),
+			                            error.msg);
+		}
+		if (algorithm == JSONHashAlgorithm::XXH64) {
+			XXH64_reset(xxh64_state, 0);
+		} else {
+			XXH3_64bits_reset(xxh3_state);
+		}
+		buffered = 0;
+		try {
+			Walk(yyjson_doc_get_root(doc), 0);
+		} catch (...) {
+			yyjson_doc_free(doc);
+			throw;
+		}
+		yyjson_doc_free(doc);
+		Flush();
+	}
+
+	uint64_t Digest64() const {
+		return algorithm == JSONHashAlgorithm::XXH64 ? XXH64_digest(xxh64_state) : XXH3_64bits_digest(xxh3_state);
+	}
+
+	uhugeint_t Digest128() const {
+		const XXH128_hash_t hash128 = XXH3_128bits_digest(xxh3_state);
+		return uhugeint_t {hash128.low64, hash128.high64};
+	}
+
+private:
+	void Flush() {
+		if (algorithm == JSONHashAlgorithm::XXH64) {
+			XXH64_update(xxh64_state, buffer, buffered);
+		} else {
+			XXH3_64bits_update(xxh3_state, buffer, buffered);
+		}
+		buffered = 0;
+	}
+
+	void Write(const void *data, const idx_t size) {
+		if (buffered + size > JSON_HASH_BUFFER_SIZE) {
+			Flush();
+			if (size > JSON_HASH_BUFFER_SIZE) {
+				// Long strings go to the hash state directly
+				if (algorithm == JSONHashAlgorithm::XXH64) {
+					XXH64_update(xxh64_state, data, size);
+				} else {
+					XXH3_64bits_update(xxh3_state, data, size);
+				}
+				return;
+			}
+		}
+		memcpy(buffer + buffered, data, size);
+		buffered += size;
+	}
+
+	void WriteTag(const char tag, const uint64_t value) {
+		uint8_t token[1 + sizeof(uint64_t)];
+		token[0] = static_cast<uint8_t>(tag);
+		Store<uint64_t>(value, token + 1);
+		Write(token, sizeof(token));
+	}
+
+	void WriteInteger(const bool negative, const uint64_t magnitude) {
+		uint8_t token[2 + sizeof(uint64_t)];
+		token[0] = 'i';
+		token[1] = negative && magnitude != 0 ? 1 : 0;
+		Store<uint64_t>(magnitude, token + 2);
+		Write(token, sizeof(token));
+	}
+
+	void WriteReal(const double value) {
+		// 2^64 as a double; integral values below it in magnitude are hashed like the same integer
+		static constexpr double TWO_POW_64 = 18446744073709551616.0;
+		if (std::trunc(value) == value && std::fabs(value) < TWO_POW_64) {
+			WriteInteger(value < 0, static_cast<uint64_t>(std::fabs(value)));
+			return;
+		}
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		WriteTag('d', bits);
+	}
+
+	void WriteString(yyjson_val *val) {
+		const auto length = yyjson_get_len(val);
+		uint8_t token[sizeof(uint64_t)];
+		Store<uint64_t>(length, token);
+		Write(token, sizeof(token));
+		Write(yyjson_get_str(val), length);
+	}
+
+	void Walk(yyjson_val *val, const idx_t depth) {
+		if (depth > JSON_HASH_MAX_DEPTH) {
+			throw InvalidInputException("json_hash: document is nested deeper than %d levels", JSON_HASH_MAX_DEPTH);
+		}
+		switch (yyjson_get_type(val)) {
+		case YYJSON_TYPE_NULL:
+			Write("n", 1);
+			break;
+		case YYJSON_TYPE_BOOL:
+			Write(yyjson_get_bool(val) ? "t" : "f", 1);
+			break;
+		case YYJSON_TYPE_NUM:
+			if (yyjson_is_uint(val)) {
+				WriteInteger(false, yyjson_get_uint(val));
+			} else if (yyjson_is_sint(val)) {
+				const auto value = yyjson_get_sint(val);
+				WriteInteger(value < 0, value < 0 ? uint64_t(0) - static_cast<uint64_t>(value) : uint64_t(value));
+			} else {
+				WriteReal(yyjson_get_real(val));
+			}
+			break;
+		case YYJSON_TYPE_STR:
+			Write("s", 1);
+			WriteString(val);
+			break;
+		case YYJSON_TYPE_ARR: {
+			WriteTag('[', yyjson_arr_size(val));
+			size_t index, max;
+			yyjson_val *element;
+			yyjson_arr_foreach(val, index, max, element) {
+				Walk(element, depth + 1);
+			}
+			break;
+		}
+		case YYJSON_TYPE_OBJ: {
+			WriteTag('{', yyjson_obj_size(val));
+			// Members are sorted in a shared scratch vector; nested objects use the space after this object's range
+			const auto begin = members.size();
+			size_t index, max;
+			yyjson_val *key, *value;
+			yyjson_obj_foreach(val, index, max, key, value) {
+				members.emplace_back(key, value);
+			}
+			std::stable_sort(members.begin() + NumericCast<int64_t>(begin), members.end(),
+			                 [](const std::pair<yyjson_val *, yyjson_val *> &a,
+			                    const std::pair<yyjson_val *, yyjson_val *> &b) {
+				                 const auto a_len = yyjson_get_len(a.first);
+				                 const auto b_len = yyjson_get_len(b.first);
+				                 const auto cmp = memcmp(yyjson_get_str(a.first), yyjson_get_str(b.first),
+				                                         MinValue(a_len, b_len));
+				                 return cmp < 0 || (cmp == 0 && a_len < b_len);
+			                 });
+			const auto end = members.size();
+			for (auto i = begin; i < end; i++) {
+				WriteString(members[i].first);
+				Walk(members[i].second, depth + 1);
+			}
+			members.resize(begin);
+			break;
+		}
+		default:
+			throw InvalidInputException("json_hash: unsupported JSON value");
+		}
+	}
+
+	JSONHashAlgorithm algorithm;
+	XXH64_state_t *xxh64_state = nullptr;
+	XXH3_state_t *xxh3_state = nullptr;
+	uint8_t buffer[JSON_HASH_BUFFER_SIZE];
+	idx_t buffered = 0;
+	vector<std::pair<yyjson_val *, yyjson_val *>> members;
+};
+
+struct JSONHashBindData : public FunctionData {
+	explicit JSONHashBindData(const JSONHashAlgorithm algorithm_p) : algorithm(algorithm_p) {
+	}
+
+	JSONHashAlgorithm algorithm;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<JSONHashBindData>(algorithm);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<JSONHashBindData>();
+		return algorithm == other.algorithm;
+	}
+};
+
+unique_ptr<FunctionData> JSONHashBind(ClientContext &context, ScalarFunction &bound_function,
+                                      vector<unique_ptr<Expression>> &arguments) {
+	auto algorithm = JSONHashAlgorithm::XXH3_64;
+	if (arguments.size() > 1) {
+		auto algo = GetConstantArgument(context, *arguments[1], "json_hash", "algo");
+		algorithm = ParseJSONHashAlgorithm(StringValue::Get(algo));
+	}
+	bound_function.return_type =
+	    algorithm == JSONHashAlgorithm::XXH3_128 ? LogicalType::UHUGEINT : LogicalType::UBIGINT;
+	return make_uniq<JSONHashBindData>(algorithm);
+}
+
+inline void JSONHashFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<JSONHashBindData>();
+	CanonicalJSONHasher hasher(bind_data.algorithm);
+	if (bind_data.algorithm == JSONHashAlgorithm::XXH3_128) {
+		UnaryExecutor::Execute<string_t, uhugeint_t>(args.data[0], result, args.size(), [&](const string_t &input) {
+			hasher.Hash(input);
+			return hasher.Digest128();
+		});
+	} else {
+		UnaryExecutor::Execute<string_t, uint64_t>(args.data[0], result, args.size(), [&](const string_t &input) {
+			hasher.Hash(input);
+			return hasher.Digest64();
+		});
+	}
+}
+
+} // namespace
+
+void RegisterJSONHashFunctions(ExtensionLoader &loader) {
+	ScalarFunctionSet json_hash_set("json_hash");
+	json_hash_set.AddFunction(
+	    ScalarFunction({LogicalType::VARCHAR}, LogicalType::UBIGINT, JSONHashFunction, JSONHashBind));
+	json_hash_set.AddFunction(ScalarFunction({LogicalType::VARCHAR, LogicalType::VARCHAR}, LogicalType::UBIGINT,
+	                                         JSONHashFunction, JSONHashBind));
+	CreateScalarFunctionInfo json_hash_info(json_hash_set);
+	json_hash_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::VARCHAR, LogicalType::VARCHAR},
+	     /* parameter_names */ {"json", "algo"},
+	     /* description */
+	     "Hashes a JSON document in canonical form: object keys sorted, whitespace and string escapes ignored and "
+	     "numbers compared by value. algo is xxh3_64 (default), xxh64 (both UBIGINT) or xxh3_128 (UHUGEINT)",
+	     /* examples */ {"json_hash('{\"b\": 1, \"a\": [1.0, 2]}')", "json_hash(doc, 'xxh3_128')"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(json_hash_info);
+}
+
+} // namespace duckdb
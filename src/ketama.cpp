@@ -0,0 +1,423 @@
+#include "duckdb.hpp"
+#include "duckdb/common/crypto/md5.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "hashfuncs_functions.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace duckdb {
+
+namespace {
+
+// Ketama consistent hash rings, bit-compatible with libketama (and twemproxy's ketama distribution with the default
+// 160 points per server).
+//
+// Server i with weight w_i gets 4 * floorf(w_i / sum(w) * vnodes / 4 * N) points, N being the server count, computed
+// in the same mix of float and double arithmetic as libketama. For k = 0, 1, ... the MD5 digest of "<server>-<k>"
+// yields four points, its 4-byte groups read little-endian. A key goes to the server of the first point >= the first
+// four digest bytes of MD5(key), wrapping around to the lowest point.
+//
+// The sorted points are stored in Eytzinger (breadth-first) order, padded to a complete tree so every search takes the
+// same number of steps, and searched without branches. A constant ring is searched for a whole vector of keys at once,
+// one tree level at a time, which keeps several independent loads in flight.
+//
+// Ring format (integers little-endian):
+//   [0..2]   magic "KTM"
+//   [3]      version
+//   [4..7]   S, the number of tree slots (2^depth - 1)
+//   [8..11]  N, the server count
+//   [12..15] slot of the lowest point, where keys past the highest point wrap to
+//   [16..]   S points, S server indexes (padding slots hold 0xFFFFFFFF), N + 1 offsets of the server names relative to
+//            the name bytes, the names
+static constexpr char KETAMA_MAGIC[] = {'K', 'T', 'M'};
+static constexpr uint8_t KETAMA_VERSION = 1;
+static constexpr idx_t KETAMA_HEADER_SIZE = 16;
+static constexpr int64_t KETAMA_DEFAULT_VNODES = 160;
+static constexpr int64_t KETAMA_MAX_VNODES = 65536;
+static constexpr idx_t KETAMA_MAX_POINTS = idx_t(1) << 24;
+static constexpr uint32_t KETAMA_PADDING = NumericLimits<uint32_t>::Maximum();
+
+struct KetamaPoint {
+	uint32_t point;
+	uint32_t server;
+};
+
+// The first four digest bytes as a little-endian integer, libketama's ketama_hashi
+inline uint32_t KetamaHash(const char *data, const idx_t size) {
+	data_t digest[MD5Context::MD5_HASH_LENGTH_BINARY];
+	MD5Context context;
+	context.Add(const_data_ptr_cast(data), size);
+	context.Finish(digest);
+	return Load<uint32_t>(digest);
+}
+
+// Place the sorted points into a complete tree in Eytzinger order; slot k (1-based) has children 2k and 2k + 1
+void FillEytzinger(const vector<KetamaPoint> &sorted, idx_t &next, const idx_t slot, vector<KetamaPoint> &tree) {
+	if (slot > tree.size()) {
+		return;
+	}
+	FillEytzinger(sorted, next, 2 * slot, tree);
+	tree[slot - 1] = next < sorted.size() ? sorted[next] : KetamaPoint {KETAMA_PADDING, KETAMA_PADDING};
+	next++;
+	FillEytzinger(sorted, next, 2 * slot + 1, tree);
+}
+
+string BuildKetamaRing(const vector<string> &servers, const vector<int64_t> &weights, const int64_t vnodes) {
+	const auto server_count = servers.size();
+	uint64_t total_weight = 0;
+	for (auto weight : weights) {
+		total_weight += static_cast<uint64_t>(weight);
+	}
+	if (total_weight == 0) {
+		throw InvalidInputException("ketama_ring: no server has any points");
+	}
+
+	vector<KetamaPoint> points;
+	data_t digest[MD5Context::MD5_HASH_LENGTH_BINARY];
+	for (idx_t i = 0; i < server_count; i++) {
+		const float pct = static_cast<float>(weights[i]) / static_cast<float>(total_weight);
+		const auto hashes = static_cast<idx_t>(std::floor(static_cast<float>(
+		    static_cast<double>(pct) * (static_cast<double>(vnodes) / 4.0) * static_cast<float>(server_count))));
+		if (points.size() + hashes * 4 > KETAMA_MAX_POINTS) {
+			throw InvalidInputException("ketama_ring: more than %d points", KETAMA_MAX_POINTS);
+		}
+		for (idx_t k = 0; k < hashes; k++) {
+			const auto label = servers[i] + "-" + std::to_string(k);
+			MD5Context context;
+			context.Add(const_data_ptr_cast(label.data()), label.size());
+			context.Finish(digest);
+			for (idx_t h = 0; h < 4; h++) {
+				points.push_back({Load<uint32_t>(digest + h * 4), static_cast<uint32_t>(i)});
+			}
+		}
+	}
+	if (points.empty()) {
+		throw InvalidInputException("ketama_ring: no server has any points");
+	}
+	// glibc's qsort, used by libketama, is a stable merge sort
+	std::stable_sort(points.begin(), points.end(),
+	                 [](const KetamaPoint &a, const KetamaPoint &b) { return a.point < b.point; });
+
+	idx_t slot_count = 1;
+	while (slot_count < points.size() + 1) {
+		slot_count *= 2;
+	}
+	vector<KetamaPoint> tree(slot_count - 1);
+	idx_t next = 0;
+	FillEytzinger(points, next, 1, tree);
+	idx_t first_slot = 1;
+	while (2 * first_slot <= tree.size()) {
+		first_slot *= 2;
+	}
+
+	idx_t name_bytes = 0;
+	for (auto &server : servers) {
+		name_bytes += server.size();
+	}
+	string ring(KETAMA_HEADER_SIZE + tree.size() * 2 * sizeof(uint32_t) + (server_count + 1) * sizeof(uint32_t) +
+	                name_bytes,
+	            '\0');
+	auto ptr = data_ptr_cast(&ring[0]);
+	memcpy(ptr, KETAMA_MAGIC, sizeof(KETAMA_MAGIC));
+	ptr[3] = KETAMA_VERSION;
+	Store<uint32_t>(static_cast<uint32_t>(tree.size()), ptr + 4);
+	Store<uint32_t>(static_cast<uint32_t>(server_count), ptr + 8);
+	Store<uint32_t>(static_cast<uint32_t>(first_slot), ptr + 12);
+	ptr += KETAMA_HEADER_SIZE;
+	for (auto &entry : tree) {
+		Store<uint32_t>(entry.point, ptr);
+		ptr += sizeof(uint32_t);
+	}
+	for (auto &entry : tree) {
+		Store<uint32_t>(entry.server, ptr);
+		ptr += sizeof(uint32_t);
+	}
+	uint32_t name_offset = 0;
+	for (auto &server : servers) {
+		Store<uint32_t>(name_offset, ptr);
+		ptr += sizeof(uint32_t);
+		name_offset += static_cast<uint32_t>(server.size());
+	}
+	Store<uint32_t>(name_offset, ptr);
+	ptr += sizeof(uint32_t);
+	for (auto &server : servers) {
+		memcpy(ptr, server.data(), server.size());
+		ptr += server.size();
+	}
+	return ring;
+}
+
+// Read-only view of a serialized ring; server and name indexes are checked when read, so a damaged ring cannot be
+// read out of bounds
+class KetamaRingView {
+public:
+	void Initialize(const string_t &ring) {
+		const auto data = const_data_ptr_cast(ring.GetData());
+		const idx_t size = ring.GetSize();
+		if (size < KETAMA_HEADER_SIZE || memcmp(data, KETAMA_MAGIC, sizeof(KETAMA_MAGIC)) != 0) {
+			throw InvalidInputException("ketama_lookup: not a Ketama ring");
+		}
+		if (data[3] != KETAMA_VERSION) {
+			throw InvalidInputException("ketama_lookup: unsupported Ketama ring version %d",
+			                            static_cast<int32_t>(data[3]));
+		}
+		slot_count = Load<uint32_t>(data + 4);
+		server_count = Load<uint32_t>(data + 8);
+		first_slot = Load<uint32_t>(data + 12);
+		const idx_t tree_size = idx_t(slot_count) * 2 * sizeof(uint32_t);
+		const idx_t offsets_size = (idx_t(server_count) + 1) * sizeof(uint32_t);
+		// A complete tree has 2^depth - 1 slots
+		if (slot_count == 0 || (slot_count & (slot_count + 1)) != 0 || first_slot == 0 || first_slot > slot_count ||
+		    size < KETAMA_HEADER_SIZE + tree_size + offsets_size) {
+			throw InvalidInputException("ketama_lookup: corrupt Ketama ring");
+		}
+		points = data + KETAMA_HEADER_SIZE;
+		servers = points + idx_t(slot_count) * sizeof(uint32_t);
+		name_offsets = points + tree_size;
+		names = name_offsets + offsets_size;
+		name_bytes = size - KETAMA_HEADER_SIZE - tree_size - offsets_size;
+	}
+
+	// Finds the slot of the first point >= hash for each hash, 0 when there is none. Every search descends all levels
+	// of the tree and steps with a conditional move, so the searches of a batch advance in lock step and their loads
+	// overlap instead of each waiting on the previous one.
+	void Search(const uint32_t *hashes, const idx_t count, uint32_t *slots) const {
+		D_ASSERT(count <= STANDARD_VECTOR_SIZE);
+		uint32_t positions[STANDARD_VECTOR_SIZE];
+		for (idx_t i = 0; i < count; i++) {
+			positions[i] = 1;
+			slots[i] = 0;
+		}
+		for (idx_t level = 1; level <= slot_count; level = 2 * level + 1) {
+			for (idx_t i = 0; i < count; i++) {
+				const auto position = positions[i];
+				const bool go_right = Load<uint32_t>(points + (position - 1) * sizeof(uint32_t)) < hashes[i];
+				slots[i] = go_right ? slots[i] : position;
+				positions[i] = 2 * position + go_right;
+			}
+		}
+	}
+
+	string_t Server(const uint32_t slot) const {
+		auto server = slot == 0 ? KETAMA_PADDING : Load<uint32_t>(servers + (slot - 1) * sizeof(uint32_t));
+		if (server == KETAMA_PADDING) {
+			// Past the highest point: wrap around to the lowest
+			server = Load<uint32_t>(servers + (first_slot - 1) * sizeof(uint32_t));
+		}
+		if (server >= server_count) {
+			throw InvalidInputException("ketama_lookup: corrupt Ketama ring");
+		}
+		const auto begin = Load<uint32_t>(name_offsets + server * sizeof(uint32_t));
+		const auto end = Load<uint32_t>(name_offsets + (server + 1) * sizeof(uint32_t));
+		if (begin > end || end > name_bytes) {
+			throw InvalidInputException("ketama_lookup: corrupt Ketama ring");
+		}
+		return string_t(const_char_ptr_cast(names + begin), end - begin);
+	}
+
+private:
+	uint32_t slot_count = 0;
+	uint32_t server_count = 0;
+	uint32_t first_slot = 0;
+	const_data_ptr_t points = nullptr;
+	const_data_ptr_t servers = nullptr;
+	const_data_ptr_t name_offsets = nullptr;
+	const_data_ptr_t names = nullptr;
+	idx_t name_bytes = 0;
+};
+
+string KetamaRingFromValues(const Value &servers_value, const Value &weights_value, const int64_t vnodes) {
+	if (vnodes < 4 || vnodes > KETAMA_MAX_VNODES || vnodes % 4 != 0) {
+		throw InvalidInputException("ketama_ring: vnodes must be a multiple of 4 between 4 and %d, got %d",
+		                            KETAMA_MAX_VNODES, vnodes);
+	}
+	vector<string> servers;
+	for (auto &server : ListValue::GetChildren(servers_value)) {
+		if (server.IsNull()) {
+			throw InvalidInputException("ketama_ring: servers cannot contain NULL");
+		}
+		servers.push_back(StringValue::Get(server));
+	}
+	if (servers.empty()) {
+		throw InvalidInputException("ketama_ring: servers cannot be empty");
+	}
+	vector<int64_t> weights(servers.size(), 1);
+	if (!weights_value.IsNull()) {
+		auto &weight_values = ListValue::GetChildren(weights_value);
+		if (weight_values.size() != servers.size()) {
+			throw InvalidInputException("ketama_ring: got %d weights for %d servers", weight_values.size(),
+			                            servers.size());
+		}
+		for (idx_t i = 0; i < servers.size(); i++) {
+			const auto weight = weight_values[i].IsNull() ? -1 : BigIntValue::Get(weight_values[i]);
+			if (weight < 0 || weight > NumericLimits<uint32_t>::Maximum()) {
+				throw InvalidInputException("ketama_ring: weights must be between 0 and %d",
+				                            NumericLimits<uint32_t>::Maximum());
+			}
+			weights[i] = weight;
+		}
+	}
+	return BuildKetamaRing(servers, weights, vnodes);
+}
+
+void KetamaRingFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	const auto row_count = args.size();
+	const bool weighted = args.ColumnCount() > 1 && args.data[1].GetType().id() == LogicalTypeId::LIST;
+	const bool has_vnodes = args.ColumnCount() > (weighted ? 2 : 1);
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto results = FlatVector::GetData<string_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+	for (idx_t i = 0; i < row_count; i++) {
+		auto servers = args.data[0].GetValue(i);
+		auto weights = weighted ? args.data[1].GetValue(i) : Value();
+		auto vnodes =
+		    has_vnodes ? args.data[args.ColumnCount() - 1].GetValue(i) : Value::BIGINT(KETAMA_DEFAULT_VNODES);
+		if (servers.IsNull() || (weighted && weights.IsNull()) || vnodes.IsNull()) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		auto ring = KetamaRingFromValues(servers, weights, vnodes.GetValue<int64_t>());
+		results[i] = StringVector::AddStringOrBlob(result, ring);
+	}
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+struct KetamaLookupBindData : public FunctionData {
+	//! The constant ring, or empty when the ring varies per row
+	explicit KetamaLookupBindData(string ring_p) : ring(std::move(ring_p)) {
+		if (!ring.empty()) {
+			view.Initialize(string_t(ring.data(), NumericCast<uint32_t>(ring.size())));
+		}
+	}
+
+	string ring;
+	KetamaRingView view;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<KetamaLookupBindData>(ring);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<KetamaLookupBindData>();
+		return ring == other.ring;
+	}
+};
+
+unique_ptr<FunctionData> KetamaLookupBind(ClientContext &context, ScalarFunction &bound_function,
+                                          vector<unique_ptr<Expression>> &arguments) {
+	if (arguments[0]->IsFoldable()) {
+		auto ring = ExpressionExecutor::EvaluateScalar(context, *arguments[0]);
+		if (!ring.IsNull()) {
+			return make_uniq<KetamaLookupBindData>(StringValue::Get(ring));
+		}
+	}
+	return make_uniq<KetamaLookupBindData>(string());
+}
+
+void KetamaLookupFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<KetamaLookupBindData>();
+	const auto row_count = args.size();
+
+	UnifiedVectorFormat key_vdata;
+	args.data[1].ToUnifiedFormat(row_count, key_vdata);
+	auto keys = UnifiedVectorFormat::GetData<string_t>(key_vdata);
+	uint32_t hashes[STANDARD_VECTOR_SIZE];
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto key_idx = key_vdata.sel->get_index(i);
+		if (key_vdata.validity.RowIsValid(key_idx)) {
+			hashes[i] = KetamaHash(keys[key_idx].GetData(), keys[key_idx].GetSize());
+		} else {
+			hashes[i] = 0;
+		}
+	}
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto results = FlatVector::GetData<string_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+
+	if (!bind_data.ring.empty()) {
+		uint32_t slots[STANDARD_VECTOR_SIZE];
+		bind_data.view.Search(hashes, row_count, slots);
+		for (idx_t i = 0; i < row_count; i++) {
+			if (!key_vdata.validity.RowIsValid(key_vdata.sel->get_index(i))) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			results[i] = StringVector::AddString(result, bind_data.view.Server(slots[i]));
+		}
+		return;
+	}
+
+	UnifiedVectorFormat ring_vdata;
+	args.data[0].ToUnifiedFormat(row_count, ring_vdata);
+	auto rings = UnifiedVectorFormat::GetData<string_t>(ring_vdata);
+	KetamaRingView view;
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto ring_idx = ring_vdata.sel->get_index(i);
+		if (!key_vdata.validity.RowIsValid(key_vdata.sel->get_index(i)) || !ring_vdata.validity.RowIsValid(ring_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		view.Initialize(rings[ring_idx]);
+		uint32_t slot;
+		view.Search(hashes + i, 1, &slot);
+		results[i] = StringVector::AddString(result, view.Server(slot));
+	}
+}
+
+} // namespace
+
+void RegisterKetamaFunctions(ExtensionLoader &loader) {
+	const auto server_list = LogicalType::LIST(LogicalType::VARCHAR);
+	const auto weight_list = LogicalType::LIST(LogicalType::BIGINT);
+	ScalarFunctionSet ring_set("ketama_ring");
+	ring_set.AddFunction(ScalarFunction({server_list}, LogicalType::BLOB, KetamaRingFunction));
+	ring_set.AddFunction(ScalarFunction({server_list, LogicalType::BIGINT}, LogicalType::BLOB, KetamaRingFunction));
+	ring_set.AddFunction(ScalarFunction({server_list, weight_list}, LogicalType::BLOB, KetamaRingFunction));
+	ring_set.AddFunction(
+	    ScalarFunction({server_list, weight_list, LogicalType::BIGINT}, LogicalType::BLOB, KetamaRingFunction));
+	CreateScalarFunctionInfo ring_info(ring_set);
+	ring_info.descriptions.push_back(
+	    {/* parameter_types */ {server_list, LogicalType::BIGINT},
+	     /* parameter_names */ {"servers", "vnodes"},
+	     /* description */
+	     "Builds a Ketama consistent hash ring, bit-compatible with libketama: vnodes points per server (default 160, "
+	     "a multiple of 4) derived from MD5(\"<server>-<n>\")",
+	     /* examples */ {"ketama_ring(['10.0.1.1:11211', '10.0.1.2:11211', '10.0.1.3:11211'])"},
+	     /* categories */ {"hash"}});
+	ring_info.descriptions.push_back(
+	    {/* parameter_types */ {server_list, weight_list, LogicalType::BIGINT},
+	     /* parameter_names */ {"servers", "weights", "vnodes"},
+	     /* description */
+	     "Builds a weighted Ketama ring: each server gets a share of the servers * vnodes points proportional to its "
+	     "weight, computed as libketama does",
+	     /* examples */ {"ketama_ring(['cache-a:11211', 'cache-b:11211'], [100, 200])"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(ring_info);
+
+	ScalarFunctionSet lookup_set("ketama_lookup");
+	lookup_set.AddFunction(ScalarFunction({LogicalType::BLOB, LogicalType::VARCHAR}, LogicalType::VARCHAR,
+	                                      KetamaLookupFunction, KetamaLookupBind));
+	lookup_set.AddFunction(ScalarFunction({LogicalType::BLOB, LogicalType::BLOB}, LogicalType::VARCHAR,
+	                                      KetamaLookupFunction, KetamaLookupBind));
+	CreateScalarFunctionInfo lookup_info(lookup_set);
+	lookup_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::VARCHAR},
+	     /* parameter_names */ {"ring", "key"},
+	     /* description */
+	     "Returns the server a Ketama ring assigns to the key, the same server libketama picks. A constant ring is "
+	     "decoded once when the query is bound and searched for a whole vector of keys at a time",
+	     /* examples */ {"ketama_lookup(ketama_ring(['cache-a:11211', 'cache-b:11211']), session_id)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(lookup_info);
+}
+
+} // namespace duckdb
@@ -0,0 +1,313 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Maglev consistent hashing (Eisenbud et al., NSDI 2016).
+//
+// Every backend gets a permutation of the M slots of a lookup table, M prime, from the 128-bit xxHash3 of its name:
+// offset = low64 % M and skip = high64 % (M - 1) + 1, slot j of the permutation being (offset + j * skip) % M. The
+// backends take turns claiming the next free slot of their permutation until the table is full, which gives every
+// backend M / N slots (within one) and moves few slots when a backend is added or removed.
+//
+// A key is looked up as entry[floor(xxh3_64(key) * M / 2^64)], one hash and one array access.
+//
+// Table format (integers little-endian):
+//   [0..2]   magic "MGL"
+//   [3]      version
+//   [4..7]   M, the table size
+//   [8..11]  N, the backend count
+//   [12]     entry width in bytes: 2 when N <= 65536, otherwise 4
+//   [13..15] reserved
+//   [16..]   M backend indexes, then N + 1 offsets of the backend names relative to the name bytes, then the names
+static constexpr char MAGLEV_MAGIC[] = {'M', 'G', 'L'};
+static constexpr uint8_t MAGLEV_VERSION = 1;
+static constexpr idx_t MAGLEV_HEADER_SIZE = 16;
+static constexpr int64_t MAGLEV_DEFAULT_TABLE_SIZE = 65537;
+static constexpr int64_t MAGLEV_MAX_TABLE_SIZE = int64_t(1) << 24;
+
+bool IsPrime(const uint64_t n) {
+	if (n < 2) {
+		return false;
+	}
+	for (uint64_t divisor = 2; divisor * divisor <= n; divisor++) {
+		if (n % divisor == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+string BuildMaglevTable(const vector<string> &backends, const uint64_t table_size) {
+	const auto backend_count = backends.size();
+	vector<uint64_t> offsets(backend_count);
+	vector<uint64_t> skips(backend_count);
+	for (idx_t i = 0; i < backend_count; i++) {
+		const auto hash = XXH3_128bits(backends[i].data(), backends[i].size());
+		offsets[i] = hash.low64 % table_size;
+		skips[i] = hash.high64 % (table_size - 1) + 1;
+	}
+
+	// Backends claim slots in turns; a permutation is a full cycle because M is prime, so each turn finds a free slot
+	vector<uint32_t> entries(table_size, NumericLimits<uint32_t>::Maximum());
+	vector<uint64_t> next(backend_count, 0);
+	idx_t filled = 0;
+	while (filled < table_size) {
+		for (idx_t i = 0; i < backend_count && filled < table_size; i++) {
+			auto slot = (offsets[i] + next[i] * skips[i]) % table_size;
+			while (entries[slot] != NumericLimits<uint32_t>::Maximum()) {
+				next[i]++;
+				slot = (offsets[i] + next[i] * skips[i]) % table_size;
+			}
+			entries[slot] = static_cast<uint32_t>(i);
+			next[i]++;
+			filled++;
+		}
+	}
+
+	const idx_t entry_width = backend_count <= 65536 ? 2 : 4;
+	idx_t name_bytes = 0;
+	for (auto &backend : backends) {
+		name_bytes += backend.size();
+	}
+	string table(MAGLEV_HEADER_SIZE + table_size * entry_width + (backend_count + 1) * sizeof(uint32_t) + name_bytes,
+	             '\0');
+	auto ptr = data_ptr_cast(&table[0]);
+	memcpy(ptr, MAGLEV_MAGIC, sizeof(MAGLEV_MAGIC));
+	ptr[3] = MAGLEV_VERSION;
+	Store<uint32_t>(static_cast<uint32_t>(table_size), ptr + 4);
+	Store<uint32_t>(static_cast<uint32_t>(backend_count), ptr + 8);
+	ptr[12] = static_cast<data_t>(entry_width);
+	ptr += MAGLEV_HEADER_SIZE;
+	for (auto entry : entries) {
+		if (entry_width == 2) {
+			Store<uint16_t>(static_cast<uint16_t>(entry), ptr);
+		} else {
+			Store<uint32_t>(entry, ptr);
+		}
+		ptr += entry_width;
+	}
+	uint32_t name_offset = 0;
+	for (auto &backend : backends) {
+		Store<uint32_t>(name_offset, ptr);
+		ptr += sizeof(uint32_t);
+		name_offset += static_cast<uint32_t>(backend.size());
+	}
+	Store<uint32_t>(name_offset, ptr);
+	ptr += sizeof(uint32_t);
+	for (auto &backend : backends) {
+		memcpy(ptr, backend.data(), backend.size());
+		ptr += backend.size();
+	}
+	return table;
+}
+
+// Read-only view of a serialized table; lookups check the indexes they read, so a damaged table cannot be read out
+// of bounds
+class MaglevTableView {
+public:
+	void Initialize(const string_t &table) {
+		const auto data = const_data_ptr_cast(table.GetData());
+		const idx_t size = table.GetSize();
+		if (size < MAGLEV_HEADER_SIZE || memcmp(data, MAGLEV_MAGIC, sizeof(MAGLEV_MAGIC)) != 0) {
+			throw InvalidInputException("maglev_lookup: not a Maglev table");
+		}
+		if (data[3] != MAGLEV_VERSION) {
+			throw InvalidInputException("maglev_lookup: unsupported Maglev table version %d",
+			                            static_cast<int32_t>(data[3]));
+		}
+		table_size = Load<uint32_t>(data + 4);
+		backend_count = Load<uint32_t>(data + 8);
+		entry_width = data[12];
+		const idx_t entries_size = idx_t(table_size) * entry_width;
+		const idx_t offsets_size = (idx_t(backend_count) + 1) * sizeof(uint32_t);
+		if (table_size == 0 || backend_count == 0 || (entry_width != 2 && entry_width != 4) ||
+		    size < MAGLEV_HEADER_SIZE + entries_size + offsets_size) {
+			throw InvalidInputException("maglev_lookup: corrupt Maglev table");
+		}
+		entries = data + MAGLEV_HEADER_SIZE;
+		name_offsets = entries + entries_size;
+		names = name_offsets + offsets_size;
+		name_bytes = size - MAGLEV_HEADER_SIZE - entries_size - offsets_size;
+	}
+
+	string_t Lookup(const uint64_t hash) const {
+		const auto slot = hash_reduce_range(hash, table_size);
+		const uint32_t backend =
+		    entry_width == 2 ? Load<uint16_t>(entries + slot * 2) : Load<uint32_t>(entries + slot * 4);
+		if (backend >= backend_count) {
+			throw InvalidInputException("maglev_lookup: corrupt Maglev table");
+		}
+		const auto begin = Load<uint32_t>(name_offsets + backend * sizeof(uint32_t));
+		const auto end = Load<uint32_t>(name_offsets + (backend + 1) * sizeof(uint32_t));
+		if (begin > end || end > name_bytes) {
+			throw InvalidInputException("maglev_lookup: corrupt Maglev table");
+		}
+		return string_t(const_char_ptr_cast(names + begin), end - begin);
+	}
+
+private:
+	uint32_t table_size = 0;
+	uint32_t backend_count = 0;
+	uint8_t entry_width = 0;
+	const_data_ptr_t entries = nullptr;
+	const_data_ptr_t name_offsets = nullptr;
+	const_data_ptr_t names = nullptr;
+	idx_t name_bytes = 0;
+};
+
+string MaglevTableFromValues(const Value &backends_value, const int64_t table_size) {
+	if (table_size < 2 || table_size > MAGLEV_MAX_TABLE_SIZE || !IsPrime(static_cast<uint64_t>(table_size))) {
+		throw InvalidInputException("maglev_table: table_size must be a prime between 2 and %d, got %d",
+		                            MAGLEV_MAX_TABLE_SIZE, table_size);
+	}
+	vector<string> backends;
+	for (auto &backend : ListValue::GetChildren(backends_value)) {
+		if (backend.IsNull()) {
+			throw InvalidInputException("maglev_table: backends cannot contain NULL");
+		}
+		backends.push_back(StringValue::Get(backend));
+	}
+	if (backends.empty() || backends.size() > static_cast<idx_t>(table_size)) {
+		throw InvalidInputException("maglev_table: need between 1 and table_size backends, got %d", backends.size());
+	}
+	return BuildMaglevTable(backends, static_cast<uint64_t>(table_size));
+}
+
+void MaglevTableFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	const auto row_count = args.size();
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto results = FlatVector::GetData<string_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+	for (idx_t i = 0; i < row_count; i++) {
+		auto backends = args.data[0].GetValue(i);
+		auto table_size = args.ColumnCount() > 1 ? args.data[1].GetValue(i) : Value::BIGINT(MAGLEV_DEFAULT_TABLE_SIZE);
+		if (backends.IsNull() || table_size.IsNull()) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		auto table = MaglevTableFromValues(backends, table_size.GetValue<int64_t>());
+		results[i] = StringVector::AddStringOrBlob(result, table);
+	}
+	if (args.AllConstant()) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+struct MaglevLookupBindData : public FunctionData {
+	//! The constant table, or empty when the table varies per row
+	explicit MaglevLookupBindData(string table_p) : table(std::move(table_p)) {
+		if (!table.empty()) {
+			view.Initialize(string_t(table.data(), NumericCast<uint32_t>(table.size())));
+		}
+	}
+
+	string table;
+	MaglevTableView view;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<MaglevLookupBindData>(table);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<MaglevLookupBindData>();
+		return table == other.table;
+	}
+};
+
+unique_ptr<FunctionData> MaglevLookupBind(ClientContext &context, ScalarFunction &bound_function,
+                                          vector<unique_ptr<Expression>> &arguments) {
+	if (!hash_vector_supports_type(arguments[1]->return_type)) {
+		throw BinderException("maglev_lookup: unsupported value type %s", arguments[1]->return_type.ToString());
+	}
+	if (arguments[0]->IsFoldable()) {
+		auto table = ExpressionExecutor::EvaluateScalar(context, *arguments[0]);
+		if (!table.IsNull()) {
+			return make_uniq<MaglevLookupBindData>(StringValue::Get(table));
+		}
+	}
+	return make_uniq<MaglevLookupBindData>(string());
+}
+
+void MaglevLookupFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<MaglevLookupBindData>();
+	const auto row_count = args.size();
+
+	Vector key_hashes(LogicalType::UBIGINT, row_count);
+	hash_vector<uint64_t, HashAlgorithm::XXH3_64>(args.data[1], row_count, key_hashes);
+	auto hashes = FlatVector::GetData<uint64_t>(key_hashes);
+	auto &hash_validity = FlatVector::Validity(key_hashes);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto results = FlatVector::GetData<string_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+
+	if (!bind_data.table.empty()) {
+		for (idx_t i = 0; i < row_count; i++) {
+			if (!hash_validity.RowIsValid(i)) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			results[i] = StringVector::AddString(result, bind_data.view.Lookup(hashes[i]));
+		}
+		return;
+	}
+
+	UnifiedVectorFormat table_vdata;
+	args.data[0].ToUnifiedFormat(row_count, table_vdata);
+	auto tables = UnifiedVectorFormat::GetData<string_t>(table_vdata);
+	MaglevTableView view;
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto table_idx = table_vdata.sel->get_index(i);
+		if (!hash_validity.RowIsValid(i) || !table_vdata.validity.RowIsValid(table_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		view.Initialize(tables[table_idx]);
+		results[i] = StringVector::AddString(result, view.Lookup(hashes[i]));
+	}
+}
+
+} // namespace
+
+void RegisterMaglevFunctions(ExtensionLoader &loader) {
+	const auto backend_list = LogicalType::LIST(LogicalType::VARCHAR);
+	ScalarFunctionSet table_set("maglev_table");
+	table_set.AddFunction(ScalarFunction({backend_list}, LogicalType::BLOB, MaglevTableFunction));
+	table_set.AddFunction(ScalarFunction({backend_list, LogicalType::BIGINT}, LogicalType::BLOB, MaglevTableFunction));
+	CreateScalarFunctionInfo table_info(table_set);
+	table_info.descriptions.push_back(
+	    {/* parameter_types */ {backend_list, LogicalType::BIGINT},
+	     /* parameter_names */ {"backends", "table_size"},
+	     /* description */
+	     "Builds a Maglev consistent hashing lookup table over the backends. table_size must be a prime (default "
+	     "65537); larger tables spread keys more evenly and move fewer keys when backends change",
+	     /* examples */ {"maglev_table(['backend-a', 'backend-b', 'backend-c'])"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(table_info);
+
+	ScalarFunctionSet lookup_set("maglev_lookup");
+	lookup_set.AddFunction(ScalarFunction({LogicalType::BLOB, LogicalType::ANY}, LogicalType::VARCHAR,
+	                                      MaglevLookupFunction, MaglevLookupBind));
+	CreateScalarFunctionInfo lookup_info(lookup_set);
+	lookup_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::ANY},
+	     /* parameter_names */ {"table", "value"},
+	     /* description */
+	     "Returns the backend a Maglev table assigns to the value: one xxh3_64 hash and one table access. A constant "
+	     "table is decoded once when the query is bound",
+	     /* examples */ {"maglev_lookup(maglev_table(['backend-a', 'backend-b']), client_ip)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(lookup_info);
+}
+
+} // namespace duckdb
@@ -0,0 +1,198 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/parser/tableref/subqueryref.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Merkle range digests for comparing a table between two databases.
+//
+// Rows are assigned to one of fanout^levels leaves by the hash of their key: leaf = floor(h * leaves / 2^64) for the
+// 64-bit key hash h. Because this is a multiply-high reduction, the parent of a leaf at any level is the leaf divided
+// by a power of fanout, so every node covers a contiguous range of the key hash space and both sides agree on the
+// ranges no matter what data they hold.
+//
+// Each node's digest is the sum modulo 2^128 of the xxh3_128_row digests of its rows. The sum is independent of row
+// order and of how the scan was parallelized, and a parent's digest is the sum of its children's, so only leaves are
+// computed from the table and the upper levels are rolled up from them.
+static constexpr int64_t MERKLE_MAX_LEAVES = int64_t(1) << 24;
+static constexpr int64_t MERKLE_MAX_FANOUT = 65536;
+
+struct DigestSumState {
+	bool is_set;
+	uhugeint_t sum;
+};
+
+struct DigestSumOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.is_set = false;
+		state.sum = uhugeint_t(0);
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input) {
+		state.is_set = true;
+		hash_digest_add(state.sum, input);
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
+	                              idx_t count) {
+		// input * count modulo 2^128; the 64x64 bit product cannot overflow 128 bits
+		uhugeint_t product = uhugeint_t(input.lower) * uhugeint_t(static_cast<uint64_t>(count));
+		product.upper += input.upper * static_cast<uint64_t>(count);
+		state.is_set = true;
+		hash_digest_add(state.sum, product);
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		if (!source.is_set) {
+			return;
+		}
+		target.is_set = true;
+		hash_digest_add(target.sum, source.sum);
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+		if (!state.is_set) {
+			finalize_data.ReturnNull();
+			return;
+		}
+		target = state.sum;
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+inline void RowHashFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	const auto row_count = args.size();
+	if (row_count == 0) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+		return;
+	}
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto &result_validity = FlatVector::Validity(result);
+	auto results = FlatVector::GetData<uhugeint_t>(result);
+	hash_struct_rows_xxh3_128(args.data[0], row_count, result_validity, results);
+
+	// Optimize for single-row results
+	if (row_count == 1) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
+}
+
+unique_ptr<FunctionData> RowHashBind(ClientContext &context, ScalarFunction &bound_function,
+                                     vector<unique_ptr<Expression>> &arguments) {
+	auto &type = arguments[0]->return_type;
+	if (type.id() != LogicalTypeId::STRUCT || !hash_row_supports_type(type)) {
+		throw BinderException("xxh3_128_row: expected a row or STRUCT of hashable fields, got %s", type.ToString());
+	}
+	bound_function.arguments[0] = type;
+	return nullptr;
+}
+
+unique_ptr<TableRef> MerkleDigestsBindReplace(ClientContext &context, TableFunctionBindInput &input) {
+	for (auto &value : input.inputs) {
+		if (value.IsNull()) {
+			throw BinderException("merkle_digests: arguments cannot be NULL");
+		}
+	}
+	const auto table_name = StringValue::Get(input.inputs[0]);
+	const auto key_column = StringValue::Get(input.inputs[1]);
+	const auto fanout = input.inputs[2].GetValue<int64_t>();
+	const auto levels = input.inputs[3].GetValue<int64_t>();
+	if (fanout < 2 || fanout > MERKLE_MAX_FANOUT) {
+		throw BinderException("merkle_digests: fanout must be between 2 and %d", MERKLE_MAX_FANOUT);
+	}
+	int64_t leaves = 1;
+	for (int64_t level = 0; level < levels; level++) {
+		leaves *= fanout;
+		if (leaves > MERKLE_MAX_LEAVES) {
+			break;
+		}
+	}
+	if (levels < 1 || leaves > MERKLE_MAX_LEAVES) {
+		throw BinderException("merkle_digests: levels must be at least 1 and fanout^levels at most %d",
+		                      MERKLE_MAX_LEAVES);
+	}
+
+	// Leaves are aggregated from the table in one parallel GROUP BY; every upper level is a GROUP BY over the leaves
+	const auto key = "__merkle_row." + KeywordHelper::WriteOptionallyQuoted(key_column);
+	string sql = "WITH __merkle_leaves AS (SELECT (((xxh3_128_row({'k': " + key + "}) >> 64) * " +
+	             std::to_string(leaves) +
+	             "::UHUGEINT) >> 64)::UBIGINT AS leaf, count(*)::UBIGINT AS row_count, "
+	             "digest_sum(xxh3_128_row(__merkle_row)) AS digest FROM query_table(" +
+	             KeywordHelper::WriteQuoted(table_name, '\'') + ") AS __merkle_row GROUP BY leaf) ";
+	int64_t divisor = leaves;
+	for (int64_t level = 0; level < levels; level++) {
+		sql += "SELECT " + std::to_string(level) + "::INTEGER AS level, (leaf // " + std::to_string(divisor) +
+		       ")::UBIGINT AS node, sum(row_count)::UBIGINT AS row_count, digest_sum(digest) AS digest "
+		       "FROM __merkle_leaves GROUP BY node UNION ALL ";
+		divisor /= fanout;
+	}
+	sql += "SELECT " + std::to_string(levels) +
+	       "::INTEGER AS level, leaf AS node, row_count, digest FROM __merkle_leaves ORDER BY level, node";
+
+	Parser parser(context.GetParserOptions());
+	parser.ParseQuery(sql);
+	auto select = unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+	return make_uniq<SubqueryRef>(std::move(select));
+}
+
+} // namespace
+
+void RegisterMerkleDigestFunctions(ExtensionLoader &loader) {
+	ScalarFunctionSet row_hash_set("xxh3_128_row");
+	row_hash_set.AddFunction(ScalarFunction({LogicalType::ANY}, LogicalType::UHUGEINT, RowHashFunction, RowHashBind));
+	CreateScalarFunctionInfo row_hash_info(row_hash_set);
+	row_hash_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY},
+	     /* parameter_names */ {"row"},
+	     /* description */
+	     "Computes a 128-bit xxHash3 digest of a whole row or STRUCT. Each field is hashed by its physical "
+	     "representation and the field digests are hashed together with a NULL bitmap",
+	     /* examples */ {"xxh3_128_row(t)", "xxh3_128_row({'id': 1, 'name': 'a'})"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(row_hash_info);
+
+	AggregateFunctionSet digest_sum_set("digest_sum");
+	auto digest_sum = AggregateFunction::UnaryAggregate<DigestSumState, uhugeint_t, uhugeint_t, DigestSumOperation>(
+	    LogicalType::UHUGEINT, LogicalType::UHUGEINT);
+	digest_sum.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+	digest_sum_set.AddFunction(digest_sum);
+	CreateAggregateFunctionInfo digest_sum_info(digest_sum_set);
+	digest_sum_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::UHUGEINT},
+	     /* parameter_names */ {"digest"},
+	     /* description */
+	     "Order-independent combination of 128-bit digests: their sum modulo 2^128. Equal multisets of digests give "
+	     "equal results regardless of row order or parallelism",
+	     /* examples */ {"digest_sum(xxh3_128_row(t))"},
+	     /* categories */ {"hash", "aggregate"}});
+	loader.RegisterFunction(digest_sum_info);
+
+	TableFunction merkle_digests("merkle_digests",
+	                             {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT},
+	                             nullptr, nullptr);
+	merkle_digests.bind_replace = MerkleDigestsBindReplace;
+	loader.RegisterFunction(merkle_digests);
+}
+
+} // namespace duckdb
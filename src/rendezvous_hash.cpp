@@ -0,0 +1,240 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace duckdb {
+
+namespace {
+
+// Rendezvous (highest random weight) hashing.
+//
+// Every (key, node) pair gets a pseudo-random score and a key is placed on the k nodes with the highest scores.
+// A node's score for a key does not depend on the other nodes, so adding or removing a node only moves the keys
+// for which that node is (or was) among the top k. With h = xxh3_64(key) and n = xxh3_64(node name):
+//
+//   m     = fmix64(h ^ n)
+//   score = m                          unweighted
+//   score = -weight / ln(u), u = ((m >> 11) + 0.5) / 2^53 in (0, 1)     weighted
+//
+// The weighted score is the logarithmic method of Schindelhauer and Schomaker: a node with weight w is the first
+// choice for a share w / sum(weights) of the keys. Ties are broken by node position.
+//
+// When the node list (and the weights) are constant, the node hashes are computed once at bind time. For each row the
+// mixing step runs over the contiguous node hashes and vectorizes; the k best nodes are then partially sorted.
+struct RendezvousNodes {
+	vector<string> names;
+	vector<uint64_t> hashes;
+	//! Empty for unweighted placement
+	vector<double> weights;
+
+	void Initialize(const Value &nodes_value, const Value &weights_value, const bool weighted) {
+		names.clear();
+		hashes.clear();
+		weights.clear();
+		auto nodes = nodes_value.DefaultCastAs(LogicalType::LIST(LogicalType::VARCHAR));
+		for (auto &node : ListValue::GetChildren(nodes)) {
+			if (node.IsNull()) {
+				throw InvalidInputException("rendezvous_hash: nodes cannot contain NULL");
+			}
+			names.push_back(StringValue::Get(node));
+			uint64_t hash;
+			hash_bytes<uint64_t, HashAlgorithm::XXH3_64>(names.back().data(), names.back().size(), hash);
+			hashes.push_back(hash);
+		}
+		if (!weighted) {
+			return;
+		}
+		auto weight_list = weights_value.DefaultCastAs(LogicalType::LIST(LogicalType::DOUBLE));
+		auto &weight_values = ListValue::GetChildren(weight_list);
+		if (weight_values.size() != names.size()) {
+			throw InvalidInputException("rendezvous_hash: got %d weights for %d nodes", weight_values.size(),
+			                            names.size());
+		}
+		for (auto &weight_value : weight_values) {
+			const auto weight = weight_value.IsNull() ? 0.0 : DoubleValue::Get(weight_value);
+			if (!(weight > 0) || !std::isfinite(weight)) {
+				throw InvalidInputException("rendezvous_hash: weights must be positive and finite");
+			}
+			weights.push_back(weight);
+		}
+	}
+
+	bool operator==(const RendezvousNodes &other) const {
+		return names == other.names && weights == other.weights;
+	}
+};
+
+// Scores all nodes for one key and returns the positions of the k best, best first
+class RendezvousSelector {
+public:
+	const vector<idx_t> &Select(const RendezvousNodes &nodes, const uint64_t key_hash, const idx_t k) {
+		const auto node_count = nodes.hashes.size();
+		const auto selected = MinValue(k, node_count);
+		mixed.resize(node_count);
+		for (idx_t i = 0; i < node_count; i++) {
+			mixed[i] = hash_fmix64(key_hash ^ nodes.hashes[i]);
+		}
+		order.resize(node_count);
+		std::iota(order.begin(), order.end(), idx_t(0));
+		if (nodes.weights.empty()) {
+			std::partial_sort(order.begin(), order.begin() + selected, order.end(), [&](idx_t a, idx_t b) {
+				return mixed[a] != mixed[b] ? mixed[a] > mixed[b] : a < b;
+			});
+		} else {
+			scores.resize(node_count);
+			for (idx_t i = 0; i < node_count; i++) {
+				const auto u = (static_cast<double>(mixed[i] >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+				scores[i] = -nodes.weights[i] / std::log(u);
+			}
+			std::partial_sort(order.begin(), order.begin() + selected, order.end(), [&](idx_t a, idx_t b) {
+				return scores[a] != scores[b] ? scores[a] > scores[b] : a < b;
+			});
+		}
+		order.resize(selected);
+		return order;
+	}
+
+private:
+	vector<uint64_t> mixed;
+	vector<double> scores;
+	vector<idx_t> order;
+};
+
+struct RendezvousBindData : public FunctionData {
+	explicit RendezvousBindData(const bool weighted_p) : weighted(weighted_p), constant_nodes(false) {
+	}
+
+	bool weighted;
+	//! Whether nodes holds the constant node list; otherwise the nodes are read per row
+	bool constant_nodes;
+	RendezvousNodes nodes;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto copy = make_uniq<RendezvousBindData>(weighted);
+		copy->constant_nodes = constant_nodes;
+		copy->nodes = nodes;
+		return std::move(copy);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RendezvousBindData>();
+		return weighted == other.weighted && constant_nodes == other.constant_nodes && nodes == other.nodes;
+	}
+};
+
+unique_ptr<FunctionData> RendezvousBind(ClientContext &context, ScalarFunction &bound_function,
+                                        vector<unique_ptr<Expression>> &arguments) {
+	if (!hash_vector_supports_type(arguments[0]->return_type)) {
+		throw BinderException("rendezvous_hash: unsupported value type %s", arguments[0]->return_type.ToString());
+	}
+	const bool weighted = arguments.size() == 4;
+	auto bind_data = make_uniq<RendezvousBindData>(weighted);
+	if (!arguments[1]->IsFoldable() || (weighted && !arguments[2]->IsFoldable())) {
+		return std::move(bind_data);
+	}
+	auto nodes = ExpressionExecutor::EvaluateScalar(context, *arguments[1]);
+	auto weights = weighted ? ExpressionExecutor::EvaluateScalar(context, *arguments[2]) : Value();
+	if (nodes.IsNull() || (weighted && weights.IsNull())) {
+		return std::move(bind_data);
+	}
+	bind_data->nodes.Initialize(nodes, weights, weighted);
+	bind_data->constant_nodes = true;
+	return std::move(bind_data);
+}
+
+void RendezvousHashFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<RendezvousBindData>();
+	const auto row_count = args.size();
+	auto &k_vector = args.data[bind_data.weighted ? 3 : 2];
+
+	Vector key_hashes(LogicalType::UBIGINT, row_count);
+	hash_vector<uint64_t, HashAlgorithm::XXH3_64>(args.data[0], row_count, key_hashes);
+	auto hashes = FlatVector::GetData<uint64_t>(key_hashes);
+	auto &hash_validity = FlatVector::Validity(key_hashes);
+
+	UnifiedVectorFormat k_vdata;
+	k_vector.ToUnifiedFormat(row_count, k_vdata);
+	auto ks = UnifiedVectorFormat::GetData<int64_t>(k_vdata);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto list_entries = FlatVector::GetData<list_entry_t>(result);
+	auto &result_validity = FlatVector::Validity(result);
+	auto &child = ListVector::GetEntry(result);
+	auto list_size = ListVector::GetListSize(result);
+
+	RendezvousNodes row_nodes;
+	RendezvousSelector selector;
+	for (idx_t i = 0; i < row_count; i++) {
+		const auto k_idx = k_vdata.sel->get_index(i);
+		if (!hash_validity.RowIsValid(i) || !k_vdata.validity.RowIsValid(k_idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		const RendezvousNodes *nodes = &bind_data.nodes;
+		if (!bind_data.constant_nodes) {
+			auto nodes_value = args.data[1].GetValue(i);
+			auto weights_value = bind_data.weighted ? args.data[2].GetValue(i) : Value();
+			if (nodes_value.IsNull() || (bind_data.weighted && weights_value.IsNull())) {
+				result_validity.SetInvalid(i);
+				continue;
+			}
+			row_nodes.Initialize(nodes_value, weights_value, bind_data.weighted);
+			nodes = &row_nodes;
+		}
+		if (ks[k_idx] < 1) {
+			throw InvalidInputException("rendezvous_hash: k must be at least 1, got %d", ks[k_idx]);
+		}
+
+		auto &selected = selector.Select(*nodes, hashes[i], static_cast<idx_t>(ks[k_idx]));
+		ListVector::Reserve(result, list_size + selected.size());
+		auto child_data = FlatVector::GetData<string_t>(child);
+		list_entries[i].offset = list_size;
+		list_entries[i].length = selected.size();
+		for (auto node : selected) {
+			child_data[list_size++] = StringVector::AddString(child, nodes->names[node]);
+		}
+	}
+	ListVector::SetListSize(result, list_size);
+}
+
+} // namespace
+
+void RegisterRendezvousHashFunctions(ExtensionLoader &loader) {
+	const auto node_list = LogicalType::LIST(LogicalType::VARCHAR);
+	const auto weight_list = LogicalType::LIST(LogicalType::DOUBLE);
+	ScalarFunctionSet rendezvous_set("rendezvous_hash");
+	rendezvous_set.AddFunction(ScalarFunction({LogicalType::ANY, node_list, LogicalType::BIGINT}, node_list,
+	                                          RendezvousHashFunction, RendezvousBind));
+	rendezvous_set.AddFunction(ScalarFunction({LogicalType::ANY, node_list, weight_list, LogicalType::BIGINT},
+	                                          node_list, RendezvousHashFunction, RendezvousBind));
+	CreateScalarFunctionInfo rendezvous_info(rendezvous_set);
+	rendezvous_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, node_list, LogicalType::BIGINT},
+	     /* parameter_names */ {"value", "nodes", "k"},
+	     /* description */
+	     "Rendezvous (highest random weight) hashing: returns the k nodes with the highest hash score for the value, "
+	     "best first. Adding or removing a node only moves the values for which it is among the top k",
+	     /* examples */ {"rendezvous_hash(object_id, ['node-a', 'node-b', 'node-c'], 2)"},
+	     /* categories */ {"hash"}});
+	rendezvous_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, node_list, weight_list, LogicalType::BIGINT},
+	     /* parameter_names */ {"value", "nodes", "weights", "k"},
+	     /* description */
+	     "Weighted rendezvous hashing: a node is the first choice for a share of values proportional to its "
+	     "positive weight. Returns the k best nodes, best first",
+	     /* examples */ {"rendezvous_hash(object_id, ['node-a', 'node-b'], [1.0, 2.0], 2)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(rendezvous_info);
+}
+
+} // namespace duckdb
@@ -0,0 +1,499 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Space-Saving heavy hitters (Metwally, Agrawal, El Abbadi) over xxh3_64 hashes of the input.
+//
+// The summary monitors a fixed number of entries. Entries are found through a small open-addressing table keyed by
+// the 64-bit hash, and kept in a stream-summary: a doubly linked list of buckets ordered by count, each bucket
+// holding the entries that share that count. Incrementing an entry moves it to the neighbouring bucket and finding
+// the minimum is reading the first bucket, so every update is O(1) regardless of how many distinct values flow by.
+// When an unmonitored value arrives and the summary is full, it takes over a minimum entry and inherits its count as
+// the error bound. The original value bytes are only copied on such inserts.
+static constexpr uint32_t SS_NONE = NumericLimits<uint32_t>::Maximum();
+static constexpr idx_t SS_MAX_K = 100000;
+// Entries monitored per requested result; extra entries make the reported top k far more accurate
+static constexpr idx_t SS_CAPACITY_FACTOR = 3;
+
+struct SpaceSavingEntry {
+	uint64_t hash;
+	uint64_t count;
+	uint64_t error;
+	string key;
+	uint32_t bucket;
+	uint32_t prev;
+	uint32_t next;
+};
+
+struct SpaceSavingBucket {
+	uint64_t count;
+	uint32_t head;
+	uint32_t prev;
+	uint32_t next;
+};
+
+class SpaceSaving {
+public:
+	explicit SpaceSaving(idx_t capacity_p) : capacity(capacity_p), min_bucket(SS_NONE), free_bucket(SS_NONE) {
+		entries.reserve(capacity);
+		idx_t table_size = 1;
+		while (table_size < capacity * 2) {
+			table_size <<= 1;
+		}
+		table.resize(table_size, SS_NONE);
+		table_mask = table_size - 1;
+	}
+
+	inline idx_t Size() const {
+		return entries.size();
+	}
+
+	inline uint64_t MinCount() const {
+		return entries.size() < capacity || min_bucket == SS_NONE ? 0 : buckets[min_bucket].count;
+	}
+
+	// Count one occurrence of a value; key_data is only read when the value is not already monitored
+	void Add(const uint64_t hash, const char *key_data, const idx_t key_size) {
+		auto slot = FindSlot(hash);
+		if (table[slot] != SS_NONE) {
+			Increment(table[slot], 1);
+			return;
+		}
+		if (entries.size() < capacity) {
+			const auto entry_idx = static_cast<uint32_t>(entries.size());
+			entries.push_back(SpaceSavingEntry {hash, 0, 0, string(key_data, key_size), SS_NONE, SS_NONE, SS_NONE});
+			table[slot] = entry_idx;
+			AttachToCountBucket(entry_idx, 1, SS_NONE);
+			return;
+		}
+		// Replace a minimum entry: the newcomer inherits its count as the error bound
+		const auto entry_idx = buckets[min_bucket].head;
+		auto &entry = entries[entry_idx];
+		EraseFromTable(entry.hash);
+		entry.hash = hash;
+		entry.error = entry.count;
+		entry.key.assign(key_data, key_size);
+		table[FindSlot(hash)] = entry_idx;
+		Increment(entry_idx, 1);
+	}
+
+	// Merge another summary into this one (Agarwal et al., "Mergeable Summaries"). A value missing from a full
+	// summary may have been counted up to that summary's minimum, which is added to both its count and error.
+	void Merge(const SpaceSaving &other) {
+		const auto this_min = MinCount();
+		const auto other_min = other.MinCount();
+
+		vector<SpaceSavingEntry> merged;
+		merged.reserve(entries.size() + other.entries.size());
+		for (auto &entry : entries) {
+			merged.push_back(entry);
+		}
+		for (auto &entry : merged) {
+			const auto other_slot = other.FindSlot(entry.hash);
+			if (other.table[other_slot] != SS_NONE) {
+				auto &other_entry = other.entries[other.table[other_slot]];
+				entry.count += other_entry.count;
+				entry.error += other_entry.error;
+			} else {
+				entry.count += other_min;
+				entry.error += other_min;
+			}
+		}
+		for (auto &other_entry : other.entries) {
+			if (table[FindSlot(other_entry.hash)] != SS_NONE) {
+				continue;
+			}
+			merged.push_back(other_entry);
+			merged.back().count += this_min;
+			merged.back().error += this_min;
+		}
+		Rebuild(std::move(merged));
+	}
+
+	// Descending estimated count, then ascending error; the hash breaks the remaining ties, so the order (and which
+	// entries a truncation keeps) does not depend on how the input was partitioned across threads
+	static bool EntryPrecedes(const SpaceSavingEntry &a, const SpaceSavingEntry &b) {
+		if (a.count != b.count) {
+			return a.count > b.count;
+		}
+		if (a.error != b.error) {
+			return a.error < b.error;
+		}
+		return a.hash < b.hash;
+	}
+
+	// Entries in EntryPrecedes order
+	vector<const SpaceSavingEntry *> TopEntries(const idx_t k) const {
+		vector<const SpaceSavingEntry *> result;
+		result.reserve(entries.size());
+		for (auto &entry : entries) {
+			result.push_back(&entry);
+		}
+		std::sort(result.begin(), result.end(),
+		          [](const SpaceSavingEntry *a, const SpaceSavingEntry *b) { return EntryPrecedes(*a, *b); });
+		if (result.size() > k) {
+			result.resize(k);
+		}
+		return result;
+	}
+
+private:
+	inline idx_t FindSlot(const uint64_t hash) const {
+		idx_t slot = static_cast<idx_t>(hash) & table_mask;
+		while (table[slot] != SS_NONE && entries[table[slot]].hash != hash) {
+			slot = (slot + 1) & table_mask;
+		}
+		return slot;
+	}
+
+	// Backward-shift deletion keeps linear probing chains intact without tombstones
+	void EraseFromTable(const uint64_t hash) {
+		idx_t hole = FindSlot(hash);
+		D_ASSERT(table[hole] != SS_NONE);
+		idx_t slot = hole;
+		while (true) {
+			slot = (slot + 1) & table_mask;
+			if (table[slot] == SS_NONE) {
+				break;
+			}
+			const idx_t home = static_cast<idx_t>(entries[table[slot]].hash) & table_mask;
+			// Move the entry into the hole unless its home lies cyclically in (hole, slot]
+			const bool stays = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+			if (!stays) {
+				table[hole] = table[slot];
+				hole = slot;
+			}
+		}
+		table[hole] = SS_NONE;
+	}
+
+	uint32_t NewBucket(const uint64_t count) {
+		uint32_t bucket_idx;
+		if (free_bucket != SS_NONE) {
+			bucket_idx = free_bucket;
+			free_bucket = buckets[bucket_idx].next;
+		} else {
+			bucket_idx = static_cast<uint32_t>(buckets.size());
+			buckets.emplace_back();
+		}
+		buckets[bucket_idx] = SpaceSavingBucket {count, SS_NONE, SS_NONE, SS_NONE};
+		return bucket_idx;
+	}
+
+	void DetachFromBucket(const uint32_t entry_idx) {
+		auto &entry = entries[entry_idx];
+		auto &bucket = buckets[entry.bucket];
+		if (entry.prev != SS_NONE) {
+			entries[entry.prev].next = entry.next;
+		} else {
+			bucket.head = entry.next;
+		}
+		if (entry.next != SS_NONE) {
+			entries[entry.next].prev = entry.prev;
+		}
+		entry.prev = entry.next = SS_NONE;
+		if (bucket.head != SS_NONE) {
+			return;
+		}
+		// Unlink the now empty bucket and put it on the free list
+		const auto bucket_idx = entry.bucket;
+		if (bucket.prev != SS_NONE) {
+			buckets[bucket.prev].next = bucket.next;
+		} else {
+			min_bucket = bucket.next;
+		}
+		if (bucket.next != SS_NONE) {
+			buckets[bucket.next].prev = bucket.prev;
+		}
+		bucket.next = free_bucket;
+		free_bucket = bucket_idx;
+	}
+
+	// Put an entry into the bucket for `count`, searching forward from `after` (or from the minimum)
+	void AttachToCountBucket(const uint32_t entry_idx, const uint64_t count, uint32_t after) {
+		uint32_t next = after == SS_NONE ? min_bucket : buckets[after].next;
+		while (next != SS_NONE && buckets[next].count < count) {
+			after = next;
+			next = buckets[next].next;
+		}
+		uint32_t bucket_idx;
+		if (next != SS_NONE && buckets[next].count == count) {
+			bucket_idx = next;
+		} else {
+			bucket_idx = NewBucket(count);
+			auto &bucket = buckets[bucket_idx];
+			bucket.prev = after;
+			bucket.next = next;
+			if (after != SS_NONE) {
+				buckets[after].next = bucket_idx;
+			} else {
+				min_bucket = bucket_idx;
+			}
+			if (next != SS_NONE) {
+				buckets[next].prev = bucket_idx;
+			}
+		}
+		auto &entry = entries[entry_idx];
+		auto &bucket = buckets[bucket_idx];
+		entry.count = count;
+		entry.bucket = bucket_idx;
+		entry.prev = SS_NONE;
+		entry.next = bucket.head;
+		if (bucket.head != SS_NONE) {
+			entries[bucket.head].prev = entry_idx;
+		}
+		bucket.head = entry_idx;
+	}
+
+	void Increment(const uint32_t entry_idx, const uint64_t amount) {
+		auto &entry = entries[entry_idx];
+		const auto old_bucket = entry.bucket;
+		const auto new_count = entry.count + amount;
+		// Sole member of its bucket and the next bucket is further away: bump the bucket in place
+		const auto &bucket = buckets[old_bucket];
+		if (bucket.head == entry_idx && entry.next == SS_NONE &&
+		    (bucket.next == SS_NONE || buckets[bucket.next].count > new_count)) {
+			buckets[old_bucket].count = new_count;
+			entry.count = new_count;
+			return;
+		}
+		// The search for the new bucket starts at the old bucket's predecessor, which survives the detach
+		const auto search_from = bucket.prev;
+		DetachFromBucket(entry_idx);
+		AttachToCountBucket(entry_idx, new_count, search_from);
+	}
+
+	void Rebuild(vector<SpaceSavingEntry> merged) {
+		std::sort(merged.begin(), merged.end(), EntryPrecedes);
+		if (merged.size() > capacity) {
+			merged.resize(capacity);
+		}
+		entries = std::move(merged);
+		buckets.clear();
+		min_bucket = free_bucket = SS_NONE;
+		std::fill(table.begin(), table.end(), SS_NONE);
+		// Entries are sorted by descending count, so attaching them in reverse builds the bucket list in order
+		// (searching from the predecessor of the last bucket so equal counts share it)
+		uint32_t last_bucket = SS_NONE;
+		for (idx_t i = entries.size(); i > 0; i--) {
+			const auto entry_idx = static_cast<uint32_t>(i - 1);
+			table[FindSlot(entries[entry_idx].hash)] = entry_idx;
+			const auto search_from = last_bucket == SS_NONE ? SS_NONE : buckets[last_bucket].prev;
+			AttachToCountBucket(entry_idx, entries[entry_idx].count, search_from);
+			last_bucket = entries[entry_idx].bucket;
+		}
+	}
+
+	idx_t capacity;
+	vector<SpaceSavingEntry> entries;
+	vector<SpaceSavingBucket> buckets;
+	uint32_t min_bucket;
+	uint32_t free_bucket;
+	vector<uint32_t> table;
+	idx_t table_mask;
+};
+
+struct SpaceSavingBindData : public FunctionData {
+	explicit SpaceSavingBindData(idx_t k_p) : k(k_p) {
+	}
+
+	idx_t k;
+
+	idx_t Capacity() const {
+		return k * SS_CAPACITY_FACTOR;
+	}
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<SpaceSavingBindData>(k);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<SpaceSavingBindData>();
+		return k == other.k;
+	}
+};
+
+struct SpaceSavingState {
+	SpaceSaving *summary;
+};
+
+struct SpaceSavingOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.summary = nullptr;
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		if (!source.summary) {
+			return;
+		}
+		if (!target.summary) {
+			target.summary = new SpaceSaving(*source.summary);
+			return;
+		}
+		target.summary->Merge(*source.summary);
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
+		if (state.summary) {
+			delete state.summary;
+			state.summary = nullptr;
+		}
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+void SpaceSavingUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vector,
+                       idx_t count) {
+	auto &bind_data = aggr_input_data.bind_data->Cast<SpaceSavingBindData>();
+	auto &input = inputs[0];
+
+	Vector hashes(LogicalType::UBIGINT, count);
+	hash_vector<uint64_t, HashAlgorithm::XXH3_64>(input, count, hashes);
+	auto hash_data = FlatVector::GetData<uint64_t>(hashes);
+	auto &hash_validity = FlatVector::Validity(hashes);
+
+	UnifiedVectorFormat idata;
+	input.ToUnifiedFormat(count, idata);
+	const auto physical_type = input.GetType().InternalType();
+	const bool is_string = physical_type == PhysicalType::VARCHAR;
+	const auto fixed_width = is_string ? 0 : GetTypeIdSize(physical_type);
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<SpaceSavingState *>(sdata);
+
+	for (idx_t i = 0; i < count; i++) {
+		if (!hash_validity.RowIsValid(i)) {
+			continue;
+		}
+		auto &state = *states[sdata.sel->get_index(i)];
+		if (!state.summary) {
+			state.summary = new SpaceSaving(bind_data.Capacity());
+		}
+		const auto input_idx = idata.sel->get_index(i);
+		if (is_string) {
+			const auto &str = UnifiedVectorFormat::GetData<string_t>(idata)[input_idx];
+			state.summary->Add(hash_data[i], str.GetData(), str.GetSize());
+		} else {
+			const auto key_ptr = const_char_ptr_cast(idata.data + input_idx * fixed_width);
+			state.summary->Add(hash_data[i], key_ptr, fixed_width);
+		}
+	}
+}
+
+void SpaceSavingFinalize(Vector &state_vector, AggregateInputData &aggr_input_data, Vector &result, idx_t count,
+                         idx_t offset) {
+	auto &bind_data = aggr_input_data.bind_data->Cast<SpaceSavingBindData>();
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<SpaceSavingState *>(sdata);
+
+	auto &mask = FlatVector::Validity(result);
+	auto list_entries = FlatVector::GetData<list_entry_t>(result);
+	auto old_len = ListVector::GetListSize(result);
+
+	idx_t new_entries = 0;
+	for (idx_t i = 0; i < count; i++) {
+		auto &state = *states[sdata.sel->get_index(i)];
+		if (state.summary) {
+			new_entries += MinValue(bind_data.k, state.summary->Size());
+		}
+	}
+	ListVector::Reserve(result, old_len + new_entries);
+
+	auto &child = ListVector::GetEntry(result);
+	auto &child_entries = StructVector::GetEntries(child);
+	auto &value_vector = *child_entries[0];
+	auto count_data = FlatVector::GetData<uint64_t>(*child_entries[1]);
+	auto error_data = FlatVector::GetData<uint64_t>(*child_entries[2]);
+	const auto physical_type = value_vector.GetType().InternalType();
+	const bool is_string = physical_type == PhysicalType::VARCHAR;
+	const auto fixed_width = is_string ? 0 : GetTypeIdSize(physical_type);
+
+	idx_t current_offset = old_len;
+	for (idx_t i = 0; i < count; i++) {
+		auto &state = *states[sdata.sel->get_index(i)];
+		const auto rid = i + offset;
+		if (!state.summary) {
+			mask.SetInvalid(rid);
+			continue;
+		}
+		auto top = state.summary->TopEntries(bind_data.k);
+		list_entries[rid].offset = current_offset;
+		list_entries[rid].length = top.size();
+		for (auto entry : top) {
+			if (is_string) {
+				FlatVector::GetData<string_t>(value_vector)[current_offset] =
+				    StringVector::AddStringOrBlob(value_vector, entry->key);
+			} else {
+				memcpy(FlatVector::GetData<data_t>(value_vector) + current_offset * fixed_width, entry->key.data(),
+				       fixed_width);
+			}
+			count_data[current_offset] = entry->count;
+			error_data[current_offset] = entry->error;
+			current_offset++;
+		}
+	}
+	ListVector::SetListSize(result, current_offset);
+	result.Verify(count);
+}
+
+unique_ptr<FunctionData> SpaceSavingBind(ClientContext &context, AggregateFunction &function,
+                                         vector<unique_ptr<Expression>> &arguments) {
+	auto &value_type = arguments[0]->return_type;
+	if (!hash_vector_supports_type(value_type)) {
+		throw BinderException("approx_top_k_hashed: unsupported value type %s", value_type.ToString());
+	}
+	auto k = GetConstantArgument(context, *arguments[1], "approx_top_k_hashed", "k").GetValue<int64_t>();
+	if (k < 1 || k > static_cast<int64_t>(SS_MAX_K)) {
+		throw BinderException("approx_top_k_hashed: k must be between 1 and %d", SS_MAX_K);
+	}
+
+	function.arguments[0] = value_type;
+	function.return_type = LogicalType::LIST(LogicalType::STRUCT(
+	    {{"value", value_type}, {"count", LogicalType::UBIGINT}, {"error", LogicalType::UBIGINT}}));
+	Function::EraseArgument(function, arguments, 1);
+	return make_uniq<SpaceSavingBindData>(static_cast<idx_t>(k));
+}
+
+} // namespace
+
+void RegisterSpaceSavingFunctions(ExtensionLoader &loader) {
+	AggregateFunctionSet top_k_set("approx_top_k_hashed");
+	AggregateFunction top_k({LogicalType::ANY, LogicalType::BIGINT}, LogicalType::LIST(LogicalType::ANY),
+	                        AggregateFunction::StateSize<SpaceSavingState>,
+	                        AggregateFunction::StateInitialize<SpaceSavingState, SpaceSavingOperation>,
+	                        SpaceSavingUpdate, AggregateFunction::StateCombine<SpaceSavingState, SpaceSavingOperation>,
+	                        SpaceSavingFinalize, nullptr, SpaceSavingBind,
+	                        AggregateFunction::StateDestroy<SpaceSavingState, SpaceSavingOperation>);
+	top_k.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+	top_k_set.AddFunction(top_k);
+	CreateAggregateFunctionInfo top_k_info(top_k_set);
+	top_k_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::BIGINT},
+	     /* parameter_names */ {"value", "k"},
+	     /* description */
+	     "Finds the approximately k most frequent values using the Space-Saving algorithm over xxh3_64 hashes, in "
+	     "memory bounded by k. Returns a list of {value, count, error} structs ordered by descending count, where "
+	     "count overestimates the true frequency by at most error",
+	     /* examples */ {"approx_top_k_hashed(url, 100)"},
+	     /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(top_k_info);
+}
+
+} // namespace duckdb
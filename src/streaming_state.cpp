@@ -0,0 +1,394 @@
+// The xxHash state structs are only declared under XXH_STATIC_LINKING_ONLY; their fields are copied one by one below
+#define XXH_STATIC_LINKING_ONLY
+
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Resumable streaming hash state as a SQL value.
+//
+// xxh3_state_init creates an empty XXH32, XXH64 or XXH3 streaming state, xxh3_state_update feeds it more bytes and
+// xxh3_state_digest returns the hash of everything fed so far, so content that arrives in pieces (appended log
+// segments, multipart uploads) can be hashed without keeping it around. The digest equals the one-shot scalar
+// function over the concatenated input.
+//
+// The state is serialized field by field into a small fixed-size BLOB rather than as the raw xxHash struct, which
+// holds pointers and whose layout depends on the library version and platform. Values derived from the seed (the
+// XXH3 custom secret, stripe counts per block) are recomputed by resetting a fresh state with the stored seed.
+//
+// Layout: "XSS" magic, format version, algorithm, 3 reserved bytes, seed (8 bytes), total input length (8 bytes),
+// buffered byte count (4 bytes), 4 reserved bytes, then the algorithm's accumulators and its whole input buffer.
+// XXH3 keeps the full 256-byte buffer because its digest reads the last stripe from the end of the buffer even when
+// fewer bytes are pending.
+static constexpr uint8_t STREAMING_STATE_FORMAT_VERSION = 1;
+static constexpr idx_t STREAMING_STATE_HEADER_SIZE = 32;
+
+enum class StreamingStateAlgorithm : uint8_t { XXH32 = 0, XXH64 = 1, XXH3_64 = 2, XXH3_128 = 3 };
+
+StreamingStateAlgorithm ParseStreamingStateAlgorithm(const string &name) {
+	const auto lower = StringUtil::Lower(name);
+	if (lower == "xxh32") {
+		return StreamingStateAlgorithm::XXH32;
+	} else if (lower == "xxh64") {
+		return StreamingStateAlgorithm::XXH64;
+	} else if (lower == "xxh3_64") {
+		return StreamingStateAlgorithm::XXH3_64;
+	} else if (lower == "xxh3_128") {
+		return StreamingStateAlgorithm::XXH3_128;
+	}
+	throw BinderException("xxh3_state_init: unsupported algo '%s', expected one of xxh32, xxh64, xxh3_64, xxh3_128",
+	                      name);
+}
+
+// Size of the accumulator section and of the input buffer for each algorithm
+constexpr idx_t StreamingStateAccumulatorSize(const StreamingStateAlgorithm algorithm) {
+	return algorithm == StreamingStateAlgorithm::XXH32   ? 4 * sizeof(uint32_t)
+	       : algorithm == StreamingStateAlgorithm::XXH64 ? 4 * sizeof(uint64_t)
+	                                                     : 8 * sizeof(uint64_t) + sizeof(uint64_t);
+}
+
+constexpr idx_t StreamingStateBufferSize(const StreamingStateAlgorithm algorithm) {
+	return algorithm == StreamingStateAlgorithm::XXH32   ? 16
+	       : algorithm == StreamingStateAlgorithm::XXH64 ? 32
+	                                                     : XXH3_INTERNALBUFFER_SIZE;
+}
+
+constexpr idx_t StreamingStateSize(const StreamingStateAlgorithm algorithm) {
+	return STREAMING_STATE_HEADER_SIZE + StreamingStateAccumulatorSize(algorithm) + StreamingStateBufferSize(algorithm);
+}
+
+// The fields copied below are xxHash internals that may change in any release, and the format version does not
+// record the library version. Pin the versions this format was written against, so that upgrading xxHash fails
+// here until the layout has been checked (and the format version bumped if it changed).
+static_assert(XXH_VERSION_NUMBER >= 801 && XXH_VERSION_NUMBER <= 803,
+              "streaming state format was written against xxHash 0.8.1-0.8.3; check the state layout for this version");
+static_assert(sizeof(XXH32_state_t::v) == 4 * sizeof(uint32_t) && sizeof(XXH32_state_t::mem32) == 16,
+              "unexpected XXH32 state layout");
+static_assert(sizeof(XXH64_state_t::v) == 4 * sizeof(uint64_t) && sizeof(XXH64_state_t::mem64) == 32,
+              "unexpected XXH64 state layout");
+static_assert(sizeof(XXH3_state_t::acc) == 8 * sizeof(uint64_t) &&
+                  sizeof(XXH3_state_t::buffer) == XXH3_INTERNALBUFFER_SIZE,
+              "unexpected XXH3 state layout");
+
+// One set of xxHash states reused for every row of a chunk: each row is deserialized, updated and serialized back
+class StreamingHashState {
+public:
+	StreamingHashState()
+	    : xxh32_state(XXH32_createState()), xxh64_state(XXH64_createState()), xxh3_state(XXH3_createState()) {
+		if (!xxh32_state || !xxh64_state || !xxh3_state) {
+			XXH32_freeState(xxh32_state);
+			XXH64_freeState(xxh64_state);
+			XXH3_freeState(xxh3_state);
+			throw OutOfMemoryException("failed to allocate xxHash streaming state");
+		}
+	}
+
+	~StreamingHashState() {
+		XXH32_freeState(xxh32_state);
+		XXH64_freeState(xxh64_state);
+		XXH3_freeState(xxh3_state);
+	}
+
+	StreamingHashState(const StreamingHashState &) = delete;
+	StreamingHashState &operator=(const StreamingHashState &) = delete;
+
+	void Reset(const StreamingStateAlgorithm algorithm_p, const uint64_t seed_p) {
+		algorithm = algorithm_p;
+		seed = seed_p;
+		switch (algorithm) {
+		case StreamingStateAlgorithm::XXH32:
+			XXH32_reset(xxh32_state, static_cast<XXH32_hash_t>(seed));
+			break;
+		case StreamingStateAlgorithm::XXH64:
+			XXH64_reset(xxh64_state, seed);
+			break;
+		case StreamingStateAlgorithm::XXH3_64:
+		case StreamingStateAlgorithm::XXH3_128:
+			// The 64- and 128-bit variants share the streaming state and only differ in the digest
+			XXH3_64bits_reset_withSeed(xxh3_state, seed);
+			break;
+		}
+	}
+
+	void Deserialize(const string_t &blob, const char *function_name) {
+		const auto blob_size = blob.GetSize();
+		const auto ptr = const_data_ptr_cast(blob.GetData());
+		if (blob_size < STREAMING_STATE_HEADER_SIZE || ptr[0] != 'X' || ptr[1] != 'S' || ptr[2] != 'S') {
+			throw InvalidInputException("%s: input is not a streaming hash state produced by xxh3_state_init",
+			                            function_name);
+		}
+		if (ptr[3] != STREAMING_STATE_FORMAT_VERSION) {
+			throw InvalidInputException("%s: unsupported streaming hash state format version %d", function_name,
+			                            static_cast<int64_t>(ptr[3]));
+		}
+		if (ptr[4] > static_cast<uint8_t>(StreamingStateAlgorithm::XXH3_128) ||
+		    blob_size != StreamingStateSize(static_cast<StreamingStateAlgorithm>(ptr[4]))) {
+			throw InvalidInputException("%s: streaming hash state is corrupt or truncated", function_name);
+		}
+		Reset(static_cast<StreamingStateAlgorithm>(ptr[4]), Load<uint64_t>(ptr + 8));
+		const auto total_length = Load<uint64_t>(ptr + 16);
+		const auto buffered = Load<uint32_t>(ptr + 24);
+		const auto accumulators = ptr + STREAMING_STATE_HEADER_SIZE;
+		const auto buffer = accumulators + StreamingStateAccumulatorSize(algorithm);
+
+		// Validate everything the xxHash code uses as an offset before installing it
+		bool valid;
+		switch (algorithm) {
+		case StreamingStateAlgorithm::XXH32:
+			valid = buffered == total_length % 16;
+			break;
+		case StreamingStateAlgorithm::XXH64:
+			valid = buffered == total_length % 32;
+			break;
+		default:
+			valid = buffered <= XXH3_INTERNALBUFFER_SIZE && buffered <= total_length &&
+			        Load<uint64_t>(accumulators + 8 * sizeof(uint64_t)) < xxh3_state->nbStripesPerBlock;
+			break;
+		}
+		if (!valid) {
+			throw InvalidInputException("%s: streaming hash state is corrupt or truncated", function_name);
+		}
+
+		switch (algorithm) {
+		case StreamingStateAlgorithm::XXH32:
+			xxh32_state->total_len_32 = static_cast<XXH32_hash_t>(total_length);
+			xxh32_state->large_len = total_length >= 16 ? 1 : 0;
+			for (idx_t i = 0; i < 4; i++) {
+				xxh32_state->v[i] = Load<uint32_t>(accumulators + i * sizeof(uint32_t));
+			}
+			memcpy(xxh32_state->mem32, buffer, sizeof(xxh32_state->mem32));
+			xxh32_state->memsize = buffered;
+			break;
+		case StreamingStateAlgorithm::XXH64:
+			xxh64_state->total_len = total_length;
+			for (idx_t i = 0; i < 4; i++) {
+				xxh64_state->v[i] = Load<uint64_t>(accumulators + i * sizeof(uint64_t));
+			}
+			memcpy(xxh64_state->mem64, buffer, sizeof(xxh64_state->mem64));
+			xxh64_state->memsize = buffered;
+			break;
+		default:
+			xxh3_state->totalLen = total_length;
+			for (idx_t i = 0; i < 8; i++) {
+				xxh3_state->acc[i] = Load<uint64_t>(accumulators + i * sizeof(uint64_t));
+			}
+			xxh3_state->nbStripesSoFar = Load<uint64_t>(accumulators + 8 * sizeof(uint64_t));
+			memcpy(xxh3_state->buffer, buffer, sizeof(xxh3_state->buffer));
+			xxh3_state->bufferedSize = buffered;
+			break;
+		}
+	}
+
+	string_t Serialize(Vector &result) const {
+		auto blob = StringVector::EmptyString(result, StreamingStateSize(algorithm));
+		auto ptr = data_ptr_cast(blob.GetDataWriteable());
+		const auto accumulators = ptr + STREAMING_STATE_HEADER_SIZE;
+		const auto buffer = accumulators + StreamingStateAccumulatorSize(algorithm);
+		uint64_t total_length;
+		uint32_t buffered;
+		switch (algorithm) {
+		case StreamingStateAlgorithm::XXH32:
+			// total_len_32 wraps at 2^32; the XXH32 digest only uses it modulo 2^32 too
+			total_length = xxh32_state->total_len_32;
+			if (xxh32_state->large_len && total_length < 16) {
+				total_length += uint64_t(1) << 32;
+			}
+			for (idx_t i = 0; i < 4; i++) {
+				Store<uint32_t>(xxh32_state->v[i], accumulators + i * sizeof(uint32_t));
+			}
+			memcpy(buffer, xxh32_state->mem32, sizeof(xxh32_state->mem32));
+			buffered = xxh32_state->memsize;
+			break;
+		case StreamingStateAlgorithm::XXH64:
+			total_length = xxh64_state->total_len;
+			for (idx_t i = 0; i < 4; i++) {
+				Store<uint64_t>(xxh64_state->v[i], accumulators + i * sizeof(uint64_t));
+			}
+			memcpy(buffer, xxh64_state->mem64, sizeof(xxh64_state->mem64));
+			buffered = xxh64_state->memsize;
+			break;
+		default:
+			total_length = xxh3_state->totalLen;
+			for (idx_t i = 0; i < 8; i++) {
+				Store<uint64_t>(xxh3_state->acc[i], accumulators + i * sizeof(uint64_t));
+			}
+			Store<uint64_t>(xxh3_state->nbStripesSoFar, accumulators + 8 * sizeof(uint64_t));
+			memcpy(buffer, xxh3_state->buffer, sizeof(xxh3_state->buffer));
+			buffered = xxh3_state->bufferedSize;
+			break;
+		}
+		ptr[0] = 'X';
+		ptr[1] = 'S';
+		ptr[2] = 'S';
+		ptr[3] = STREAMING_STATE_FORMAT_VERSION;
+		ptr[4] = static_cast<uint8_t>(algorithm);
+		ptr[5] = ptr[6] = ptr[7] = 0;
+		Store<uint64_t>(seed, ptr + 8);
+		Store<uint64_t>(total_length, ptr + 16);
+		Store<uint32_t>(buffered, ptr + 24);
+		Store<uint32_t>(0, ptr + 28);
+		blob.Finalize();
+		return blob;
+	}
+
+	void Update(const string_t &data) {
+		switch (algorithm) {
+		case StreamingStateAlgorithm::XXH32:
+			XXH32_update(xxh32_state, data.GetData(), data.GetSize());
+			break;
+		case StreamingStateAlgorithm::XXH64:
+			XXH64_update(xxh64_state, data.GetData(), data.GetSize());
+			break;
+		default:
+			XXH3_64bits_update(xxh3_state, data.GetData(), data.GetSize());
+			break;
+		}
+	}
+
+	// The digest widened to UHUGEINT, equal to what xxh32, xxh64, xxh3_64 or xxh3_128 return for the whole input
+	uhugeint_t Digest() const {
+		switch (algorithm) {
+		case StreamingStateAlgorithm::XXH32:
+			return uhugeint_t(static_cast<uint64_t>(XXH32_digest(xxh32_state)));
+		case StreamingStateAlgorithm::XXH64:
+			return uhugeint_t(XXH64_digest(xxh64_state));
+		case StreamingStateAlgorithm::XXH3_64:
+			return uhugeint_t(XXH3_64bits_digest(xxh3_state));
+		default: {
+			const XXH128_hash_t hash128 = XXH3_128bits_digest(xxh3_state);
+			return uhugeint_t {hash128.low64, hash128.high64};
+		}
+		}
+	}
+
+private:
+	StreamingStateAlgorithm algorithm = StreamingStateAlgorithm::XXH3_128;
+	uint64_t seed = 0;
+	XXH32_state_t *xxh32_state;
+	XXH64_state_t *xxh64_state;
+	XXH3_state_t *xxh3_state;
+};
+
+struct StreamingStateInitBindData : public FunctionData {
+	StreamingStateInitBindData(const StreamingStateAlgorithm algorithm_p, const uint64_t seed_p)
+	    : algorithm(algorithm_p), seed(seed_p) {
+	}
+
+	StreamingStateAlgorithm algorithm;
+	uint64_t seed;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<StreamingStateInitBindData>(algorithm, seed);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<StreamingStateInitBindData>();
+		return algorithm == other.algorithm && seed == other.seed;
+	}
+};
+
+unique_ptr<FunctionData> StreamingStateInitBind(ClientContext &context, ScalarFunction &bound_function,
+                                                vector<unique_ptr<Expression>> &arguments) {
+	auto algorithm = StreamingStateAlgorithm::XXH3_128;
+	uint64_t seed = 0;
+	if (arguments.size() > 0) {
+		auto algo = GetConstantArgument(context, *arguments[0], "xxh3_state_init", "algo");
+		algorithm = ParseStreamingStateAlgorithm(StringValue::Get(algo));
+	}
+	if (arguments.size() > 1) {
+		seed = GetConstantArgument(context, *arguments[1], "xxh3_state_init", "seed").GetValue<uint64_t>();
+		if (algorithm == StreamingStateAlgorithm::XXH32 && seed > NumericLimits<uint32_t>::Maximum()) {
+			throw BinderException("xxh3_state_init: seed for xxh32 must fit in 32 bits");
+		}
+	}
+	return make_uniq<StreamingStateInitBindData>(algorithm, seed);
+}
+
+inline void StreamingStateInitFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<StreamingStateInitBindData>();
+	StreamingHashState hash_state;
+	hash_state.Reset(bind_data.algorithm, bind_data.seed);
+	result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	ConstantVector::GetData<string_t>(result)[0] = hash_state.Serialize(result);
+}
+
+inline void StreamingStateUpdateFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	StreamingHashState hash_state;
+	BinaryExecutor::Execute<string_t, string_t, string_t>(args.data[0], args.data[1], result, args.size(),
+	                                                      [&](const string_t &blob, const string_t &data) {
+		                                                      hash_state.Deserialize(blob, "xxh3_state_update");
+		                                                      hash_state.Update(data);
+		                                                      return hash_state.Serialize(result);
+	                                                      });
+}
+
+inline void StreamingStateDigestFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	StreamingHashState hash_state;
+	UnaryExecutor::Execute<string_t, uhugeint_t>(args.data[0], result, args.size(), [&](const string_t &blob) {
+		hash_state.Deserialize(blob, "xxh3_state_digest");
+		return hash_state.Digest();
+	});
+}
+
+} // namespace
+
+void RegisterStreamingStateFunctions(ExtensionLoader &loader) {
+	ScalarFunctionSet init_set("xxh3_state_init");
+	for (auto &arguments : vector<vector<LogicalType>> {
+	         {}, {LogicalType::VARCHAR}, {LogicalType::VARCHAR, LogicalType::UBIGINT}}) {
+		init_set.AddFunction(
+		    ScalarFunction(arguments, LogicalType::BLOB, StreamingStateInitFunction, StreamingStateInitBind));
+	}
+	CreateScalarFunctionInfo init_info(init_set);
+	init_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::VARCHAR, LogicalType::UBIGINT},
+	     /* parameter_names */ {"algo", "seed"},
+	     /* description */
+	     "Creates an empty resumable hash state for xxh32, xxh64, xxh3_64 or xxh3_128 (the default) as a BLOB. Feed it "
+	     "with xxh3_state_update and read the hash with xxh3_state_digest",
+	     /* examples */ {"xxh3_state_init()", "xxh3_state_init('xxh64', 42)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(init_info);
+
+	ScalarFunctionSet update_set("xxh3_state_update");
+	for (auto &data_type : {LogicalType::BLOB, LogicalType::VARCHAR}) {
+		update_set.AddFunction(
+		    ScalarFunction({LogicalType::BLOB, data_type}, LogicalType::BLOB, StreamingStateUpdateFunction));
+	}
+	CreateScalarFunctionInfo update_info(update_set);
+	update_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::BLOB},
+	     /* parameter_names */ {"state", "data"},
+	     /* description */
+	     "Returns the hash state after appending data to the input it has already seen. The state can be stored in a "
+	     "table and updated again later",
+	     /* examples */ {"xxh3_state_update(xxh3_state_init(), 'hello ')"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(update_info);
+
+	ScalarFunctionSet digest_set("xxh3_state_digest");
+	digest_set.AddFunction(ScalarFunction({LogicalType::BLOB}, LogicalType::UHUGEINT, StreamingStateDigestFunction));
+	CreateScalarFunctionInfo digest_info(digest_set);
+	digest_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB},
+	     /* parameter_names */ {"state"},
+	     /* description */
+	     "Returns the hash of all input fed to a hash state, equal to the one-shot xxh32, xxh64, xxh3_64 or xxh3_128 "
+	     "of the concatenated input. Does not modify the state",
+	     /* examples */ {"xxh3_state_digest(xxh3_state_update(xxh3_state_init(), 'hello'))"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(digest_info);
+}
+
+} // namespace duckdb
@@ -0,0 +1,380 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/unordered_set.hpp"
+#include "duckdb/common/vector_operations/binary_executor.hpp"
+#include "duckdb/common/vector_operations/unary_executor.hpp"
+#include "duckdb/function/aggregate_function.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Theta (KMV) sketch over xxh3_64 hashes.
+//
+// A sketch retains every distinct hash below a threshold theta, in ascending order. While building, the aggregate
+// keeps the k + 1 smallest distinct hashes in a max-heap; the largest of them becomes theta and the k below it are
+// retained, so the distinct count estimate is retained / (theta / 2^64). Sketches with fewer than k distinct values
+// keep theta at its maximum and are exact.
+//
+// Set operations work directly on the serialized sorted arrays (a single merge walk) without building any
+// in-memory structure: the result theta is the smaller of the two inputs and only hashes below it take part.
+//
+// Serialized layout (little-endian):
+//   [0..3]   magic "THE" + format version
+//   [4..7]   k (nominal number of retained hashes)
+//   [8..11]  number of retained hashes
+//   [12..15] reserved (0)
+//   [16..23] theta; UINT64_MAX means no sampling (theta = 1.0)
+//   [24..]   retained hashes, uint64 each, strictly ascending and below theta
+static constexpr idx_t THETA_HEADER_SIZE = 24;
+static constexpr uint8_t THETA_FORMAT_VERSION = 1;
+static constexpr idx_t THETA_MAX_K = idx_t(1) << 22;
+static constexpr uint64_t THETA_MAX = NumericLimits<uint64_t>::Maximum();
+
+struct ThetaSketchView {
+	uint32_t k = 0;
+	uint32_t count = 0;
+	uint64_t theta = THETA_MAX;
+	const_data_ptr_t hashes = nullptr;
+
+	static ThetaSketchView Parse(const string_t &blob, const char *function_name) {
+		const auto size = blob.GetSize();
+		const auto ptr = const_data_ptr_cast(blob.GetData());
+		if (size < THETA_HEADER_SIZE || ptr[0] != 'T' || ptr[1] != 'H' || ptr[2] != 'E') {
+			throw InvalidInputException("%s: input is not a theta sketch produced by theta_sketch", function_name);
+		}
+		if (ptr[3] != THETA_FORMAT_VERSION) {
+			throw InvalidInputException("%s: unsupported theta sketch format version %d", function_name,
+			                            static_cast<int64_t>(ptr[3]));
+		}
+		ThetaSketchView view;
+		view.k = Load<uint32_t>(ptr + 4);
+		view.count = Load<uint32_t>(ptr + 8);
+		view.theta = Load<uint64_t>(ptr + 16);
+		if (size != THETA_HEADER_SIZE + view.count * sizeof(uint64_t) || view.count > view.k) {
+			throw InvalidInputException("%s: theta sketch is corrupt or truncated", function_name);
+		}
+		view.hashes = ptr + THETA_HEADER_SIZE;
+		return view;
+	}
+
+	inline uint64_t Hash(const idx_t i) const {
+		return Load<uint64_t>(hashes + i * sizeof(uint64_t));
+	}
+
+	double Estimate() const {
+		if (theta == THETA_MAX) {
+			return static_cast<double>(count);
+		}
+		return static_cast<double>(count) / (static_cast<double>(theta) / 18446744073709551616.0);
+	}
+};
+
+string_t WriteThetaSketch(Vector &result, const uint32_t k, const uint64_t theta, const uint64_t *hashes,
+                          const idx_t count) {
+	auto blob = StringVector::EmptyString(result, THETA_HEADER_SIZE + count * sizeof(uint64_t));
+	auto ptr = data_ptr_cast(blob.GetDataWriteable());
+	ptr[0] = 'T';
+	ptr[1] = 'H';
+	ptr[2] = 'E';
+	ptr[3] = THETA_FORMAT_VERSION;
+	Store<uint32_t>(k, ptr + 4);
+	Store<uint32_t>(static_cast<uint32_t>(count), ptr + 8);
+	Store<uint32_t>(0, ptr + 12);
+	Store<uint64_t>(theta, ptr + 16);
+	if (count > 0) {
+		memcpy(ptr + THETA_HEADER_SIZE, hashes, count * sizeof(uint64_t));
+	}
+	blob.Finalize();
+	return blob;
+}
+
+struct ThetaSketchBuilder {
+	explicit ThetaSketchBuilder(idx_t k_p) : k(k_p) {
+	}
+
+	idx_t k;
+	// Max-heap of the k + 1 smallest distinct hashes seen so far
+	vector<uint64_t> heap;
+	unordered_set<uint64_t> members;
+
+	inline void Add(const uint64_t hash) {
+		if (heap.size() > k && hash >= heap.front()) {
+			// Cheap rejection for the vast majority of rows once the sketch is full
+			return;
+		}
+		if (!members.insert(hash).second) {
+			return;
+		}
+		heap.push_back(hash);
+		std::push_heap(heap.begin(), heap.end());
+		if (heap.size() > k + 1) {
+			std::pop_heap(heap.begin(), heap.end());
+			members.erase(heap.back());
+			heap.pop_back();
+		}
+	}
+
+	void Merge(const ThetaSketchBuilder &other) {
+		for (auto hash : other.heap) {
+			Add(hash);
+		}
+	}
+
+	string_t Serialize(Vector &result) const {
+		vector<uint64_t> sorted(heap);
+		std::sort(sorted.begin(), sorted.end());
+		uint64_t theta = THETA_MAX;
+		if (sorted.size() > k) {
+			theta = sorted.back();
+			sorted.pop_back();
+		}
+		return WriteThetaSketch(result, static_cast<uint32_t>(k), theta, sorted.data(), sorted.size());
+	}
+};
+
+struct ThetaSketchBindData : public FunctionData {
+	explicit ThetaSketchBindData(idx_t k_p) : k(k_p) {
+	}
+
+	idx_t k;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<ThetaSketchBindData>(k);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<ThetaSketchBindData>();
+		return k == other.k;
+	}
+};
+
+struct ThetaSketchState {
+	ThetaSketchBuilder *builder;
+};
+
+struct ThetaSketchOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.builder = nullptr;
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &aggr_input_data) {
+		if (!source.builder) {
+			return;
+		}
+		if (!target.builder) {
+			target.builder = new ThetaSketchBuilder(*source.builder);
+			return;
+		}
+		target.builder->Merge(*source.builder);
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+		if (state.builder) {
+			target = state.builder->Serialize(finalize_data.result);
+			return;
+		}
+		// An empty group is an empty (exact) sketch, which keeps set operations well defined
+		auto &bind_data = finalize_data.input.bind_data->Cast<ThetaSketchBindData>();
+		target = WriteThetaSketch(finalize_data.result, static_cast<uint32_t>(bind_data.k), THETA_MAX, nullptr, 0);
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
+		if (state.builder) {
+			delete state.builder;
+			state.builder = nullptr;
+		}
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+void ThetaSketchUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count, Vector &state_vector,
+                       idx_t count) {
+	auto &bind_data = aggr_input_data.bind_data->Cast<ThetaSketchBindData>();
+
+	Vector hashes(LogicalType::UBIGINT, count);
+	hash_vector<uint64_t, HashAlgorithm::XXH3_64>(inputs[0], count, hashes);
+	auto hash_data = FlatVector::GetData<uint64_t>(hashes);
+	auto &hash_validity = FlatVector::Validity(hashes);
+
+	UnifiedVectorFormat sdata;
+	state_vector.ToUnifiedFormat(count, sdata);
+	auto states = UnifiedVectorFormat::GetData<ThetaSketchState *>(sdata);
+
+	for (idx_t i = 0; i < count; i++) {
+		if (!hash_validity.RowIsValid(i)) {
+			continue;
+		}
+		auto &state = *states[sdata.sel->get_index(i)];
+		if (!state.builder) {
+			state.builder = new ThetaSketchBuilder(bind_data.k);
+		}
+		state.builder->Add(hash_data[i]);
+	}
+}
+
+unique_ptr<FunctionData> ThetaSketchBind(ClientContext &context, AggregateFunction &function,
+                                         vector<unique_ptr<Expression>> &arguments) {
+	auto &value_type = arguments[0]->return_type;
+	if (!hash_vector_supports_type(value_type)) {
+		throw BinderException("theta_sketch: unsupported value type %s", value_type.ToString());
+	}
+	auto k = GetConstantArgument(context, *arguments[1], "theta_sketch", "k").GetValue<int64_t>();
+	if (k < 1 || k > static_cast<int64_t>(THETA_MAX_K)) {
+		throw BinderException("theta_sketch: k must be between 1 and %d", THETA_MAX_K);
+	}
+	Function::EraseArgument(function, arguments, 1);
+	return make_uniq<ThetaSketchBindData>(static_cast<idx_t>(k));
+}
+
+enum class ThetaSetOperation { UNION, INTERSECT, A_NOT_B };
+
+template <ThetaSetOperation OPERATION>
+string_t ThetaSetOperationApply(const ThetaSketchView &a, const ThetaSketchView &b, vector<uint64_t> &buffer,
+                                Vector &result) {
+	uint64_t theta = MinValue(a.theta, b.theta);
+	// A-not-B is a subset of A and keeps its nominal size; the other operations take the smaller one
+	const uint32_t k = OPERATION == ThetaSetOperation::A_NOT_B ? a.k : MinValue(a.k, b.k);
+	buffer.clear();
+
+	// Single merge walk over both ascending arrays, stopping at theta
+	idx_t i = 0;
+	idx_t j = 0;
+	while (i < a.count || j < b.count) {
+		const uint64_t ha = i < a.count ? a.Hash(i) : THETA_MAX;
+		const uint64_t hb = j < b.count ? b.Hash(j) : THETA_MAX;
+		const uint64_t h = MinValue(ha, hb);
+		if (h >= theta) {
+			break;
+		}
+		const bool in_a = ha == h && i < a.count;
+		const bool in_b = hb == h && j < b.count;
+		if (OPERATION == ThetaSetOperation::UNION) {
+			buffer.push_back(h);
+		} else if (OPERATION == ThetaSetOperation::INTERSECT) {
+			if (in_a && in_b) {
+				buffer.push_back(h);
+			}
+		} else if (in_a && !in_b) {
+			buffer.push_back(h);
+		}
+		i += in_a;
+		j += in_b;
+	}
+	if (buffer.size() > k) {
+		// Keep the result at the nominal size: the first dropped hash becomes the new theta
+		theta = buffer[k];
+		buffer.resize(k);
+	}
+	return WriteThetaSketch(result, k, theta, buffer.data(), buffer.size());
+}
+
+template <ThetaSetOperation OPERATION>
+void ThetaSetOperationFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	const char *function_name = OPERATION == ThetaSetOperation::UNION       ? "theta_union"
+	                            : OPERATION == ThetaSetOperation::INTERSECT ? "theta_intersect"
+	                                                                        : "theta_anotb";
+	vector<uint64_t> buffer;
+	BinaryExecutor::Execute<string_t, string_t, string_t>(
+	    args.data[0], args.data[1], result, args.size(), [&](string_t a_blob, string_t b_blob) {
+		    auto a = ThetaSketchView::Parse(a_blob, function_name);
+		    auto b = ThetaSketchView::Parse(b_blob, function_name);
+		    return ThetaSetOperationApply<OPERATION>(a, b, buffer, result);
+	    });
+}
+
+void ThetaEstimateFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	UnaryExecutor::Execute<string_t, double>(args.data[0], result, args.size(), [&](string_t blob) {
+		return ThetaSketchView::Parse(blob, "theta_estimate").Estimate();
+	});
+}
+
+} // namespace
+
+void RegisterThetaSketchFunctions(ExtensionLoader &loader) {
+	AggregateFunctionSet theta_sketch_set("theta_sketch");
+	AggregateFunction theta_sketch(
+	    {LogicalType::ANY, LogicalType::INTEGER}, LogicalType::BLOB, AggregateFunction::StateSize<ThetaSketchState>,
+	    AggregateFunction::StateInitialize<ThetaSketchState, ThetaSketchOperation>, ThetaSketchUpdate,
+	    AggregateFunction::StateCombine<ThetaSketchState, ThetaSketchOperation>,
+	    AggregateFunction::StateFinalize<ThetaSketchState, string_t, ThetaSketchOperation>, nullptr, ThetaSketchBind,
+	    AggregateFunction::StateDestroy<ThetaSketchState, ThetaSketchOperation>);
+	theta_sketch.order_dependent = AggregateOrderDependent::NOT_ORDER_DEPENDENT;
+	theta_sketch.distinct_dependent = AggregateDistinctDependent::NOT_DISTINCT_DEPENDENT;
+	theta_sketch_set.AddFunction(theta_sketch);
+	CreateAggregateFunctionInfo theta_sketch_info(theta_sketch_set);
+	theta_sketch_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::ANY, LogicalType::INTEGER},
+	     /* parameter_names */ {"value", "k"},
+	     /* description */
+	     "Builds a theta (k minimum values) sketch of the distinct xxh3_64 hashes of the input, retaining at most k "
+	     "hashes. The BLOB result can be combined with theta_union, theta_intersect and theta_anotb and "
+	     "measured with theta_estimate",
+	     /* examples */ {"theta_sketch(user_id, 4096)"},
+	     /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(theta_sketch_info);
+
+	ScalarFunctionSet theta_union_set("theta_union");
+	theta_union_set.AddFunction(ScalarFunction({LogicalType::BLOB, LogicalType::BLOB}, LogicalType::BLOB,
+	                                           ThetaSetOperationFunction<ThetaSetOperation::UNION>));
+	CreateScalarFunctionInfo theta_union_info(theta_union_set);
+	theta_union_info.descriptions.push_back({/* parameter_types */ {LogicalType::BLOB, LogicalType::BLOB},
+	                                         /* parameter_names */ {"sketch_a", "sketch_b"},
+	                                         /* description */ "Returns the theta sketch of the union of two sets",
+	                                         /* examples */ {"theta_union(monday, tuesday)"},
+	                                         /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(theta_union_info);
+
+	ScalarFunctionSet theta_intersect_set("theta_intersect");
+	theta_intersect_set.AddFunction(ScalarFunction({LogicalType::BLOB, LogicalType::BLOB}, LogicalType::BLOB,
+	                                               ThetaSetOperationFunction<ThetaSetOperation::INTERSECT>));
+	CreateScalarFunctionInfo theta_intersect_info(theta_intersect_set);
+	theta_intersect_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::BLOB},
+	     /* parameter_names */ {"sketch_a", "sketch_b"},
+	     /* description */ "Returns the theta sketch of the intersection of two sets",
+	     /* examples */ {"theta_intersect(monday, tuesday)"},
+	     /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(theta_intersect_info);
+
+	ScalarFunctionSet theta_anotb_set("theta_anotb");
+	theta_anotb_set.AddFunction(ScalarFunction({LogicalType::BLOB, LogicalType::BLOB}, LogicalType::BLOB,
+	                                           ThetaSetOperationFunction<ThetaSetOperation::A_NOT_B>));
+	CreateScalarFunctionInfo theta_anotb_info(theta_anotb_set);
+	theta_anotb_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::BLOB},
+	     /* parameter_names */ {"sketch_a", "sketch_b"},
+	     /* description */ "Returns the theta sketch of the values in the first set that are not in the second",
+	     /* examples */ {"theta_anotb(monday, tuesday)"},
+	     /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(theta_anotb_info);
+
+	ScalarFunctionSet theta_estimate_set("theta_estimate");
+	theta_estimate_set.AddFunction(
+	    ScalarFunction({LogicalType::BLOB}, LogicalType::DOUBLE, ThetaEstimateFunction));
+	CreateScalarFunctionInfo theta_estimate_info(theta_estimate_set);
+	theta_estimate_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB},
+	     /* parameter_names */ {"sketch"},
+	     /* description */
+	     "Estimates the number of distinct values in a theta sketch. Exact when fewer than k distinct values were "
+	     "added",
+	     /* examples */ {"theta_estimate(theta_sketch(user_id, 4096))"},
+	     /* categories */ {"hash", "sketch"}});
+	loader.RegisterFunction(theta_estimate_info);
+}
+
+} // namespace duckdb
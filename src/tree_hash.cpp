@@ -0,0 +1,150 @@
+#include "duckdb.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/function/scalar_function.hpp"
+#include "duckdb/parallel/task_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "bind_helpers.hpp"
+#include "hash_kernels.hpp"
+#include "hashfuncs_functions.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// Tree hashing of single large values.
+//
+// DuckDB parallelizes across rows, so hashing one multi-gigabyte BLOB with xxh3_128 runs on a single core.
+// xxh3_128_tree splits the value into fixed-size chunks, hashes the chunks on DuckDB's task scheduler and then hashes
+// the list of chunk digests. The chunk boundaries depend only on chunk_size, never on the thread count, so the
+// result is the same on every machine:
+//
+//   leaf_i = XXH3_128(chunk_i) in canonical (big-endian) form
+//   root   = XXH3_128(leaf_0 || ... || leaf_n-1 || total_length as 8 bytes LE || chunk_size as 8 bytes LE)
+//
+// The root is returned like xxh3_128 returns its digest. Values smaller than TREE_HASH_PARALLEL_THRESHOLD are
+// hashed on the calling thread; scheduling tasks would cost more than it saves.
+static constexpr idx_t TREE_HASH_DEFAULT_CHUNK_SIZE = idx_t(1) << 20;
+static constexpr idx_t TREE_HASH_MIN_CHUNK_SIZE = 1024;
+static constexpr idx_t TREE_HASH_PARALLEL_THRESHOLD = idx_t(8) << 20;
+
+void HashTreeLeaves(const_data_ptr_t data, const idx_t size, const idx_t chunk_size, const idx_t chunk_begin,
+                    const idx_t chunk_end, XXH128_canonical_t *leaves) {
+	for (idx_t chunk = chunk_begin; chunk < chunk_end; chunk++) {
+		const auto offset = chunk * chunk_size;
+		XXH128_canonicalFromHash(&leaves[chunk], XXH3_128bits(data + offset, MinValue(chunk_size, size - offset)));
+	}
+}
+
+// Hashes a contiguous range of chunks; ranges are disjoint so tasks write to separate leaves
+class TreeHashTask : public BaseExecutorTask {
+public:
+	TreeHashTask(TaskExecutor &executor, const_data_ptr_t data_p, const idx_t size_p, const idx_t chunk_size_p,
+	             const idx_t chunk_begin_p, const idx_t chunk_end_p, XXH128_canonical_t *leaves_p)
+	    : BaseExecutorTask(executor), data(data_p), size(size_p), chunk_size(chunk_size_p), chunk_begin(chunk_begin_p),
+	      chunk_end(chunk_end_p), leaves(leaves_p) {
+	}
+
+	void ExecuteTask() override {
+		HashTreeLeaves(data, size, chunk_size, chunk_begin, chunk_end, leaves);
+	}
+
+private:
+	const_data_ptr_t data;
+	idx_t size;
+	idx_t chunk_size;
+	idx_t chunk_begin;
+	idx_t chunk_end;
+	XXH128_canonical_t *leaves;
+};
+
+uhugeint_t TreeHash(ClientContext &context, const string_t &input, const idx_t chunk_size) {
+	const auto data = const_data_ptr_cast(input.GetData());
+	const idx_t size = input.GetSize();
+	const idx_t chunk_count = (size + chunk_size - 1) / chunk_size;
+	// The trailer occupies one extra 16-byte slot after the leaves so the root is hashed in one call
+	vector<XXH128_canonical_t> leaves(chunk_count + 1);
+
+	auto &scheduler = TaskScheduler::GetScheduler(context);
+	const auto task_count = MinValue<idx_t>(NumericCast<idx_t>(scheduler.NumberOfThreads()), chunk_count);
+	if (size >= TREE_HASH_PARALLEL_THRESHOLD && task_count > 1) {
+		TaskExecutor executor(context);
+		for (idx_t task = 0; task < task_count; task++) {
+			executor.ScheduleTask(make_uniq<TreeHashTask>(executor, data, size, chunk_size,
+			                                              chunk_count * task / task_count,
+			                                              chunk_count * (task + 1) / task_count, leaves.data()));
+		}
+		executor.WorkOnTasks();
+	} else {
+		HashTreeLeaves(data, size, chunk_size, 0, chunk_count, leaves.data());
+	}
+
+	auto trailer = leaves[chunk_count].digest;
+	Store<uint64_t>(size, trailer);
+	Store<uint64_t>(chunk_size, trailer + sizeof(uint64_t));
+	const XXH128_hash_t hash128 = XXH3_128bits(leaves.data(), leaves.size() * sizeof(XXH128_canonical_t));
+	return uhugeint_t {hash128.low64, hash128.high64};
+}
+
+struct TreeHashBindData : public FunctionData {
+	explicit TreeHashBindData(const idx_t chunk_size_p) : chunk_size(chunk_size_p) {
+	}
+
+	idx_t chunk_size;
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<TreeHashBindData>(chunk_size);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<TreeHashBindData>();
+		return chunk_size == other.chunk_size;
+	}
+};
+
+unique_ptr<FunctionData> TreeHashBind(ClientContext &context, ScalarFunction &bound_function,
+                                      vector<unique_ptr<Expression>> &arguments) {
+	if (arguments.size() < 2) {
+		return make_uniq<TreeHashBindData>(TREE_HASH_DEFAULT_CHUNK_SIZE);
+	}
+	const auto chunk_size =
+	    GetConstantArgument(context, *arguments[1], "xxh3_128_tree", "chunk_size").GetValue<int64_t>();
+	if (chunk_size < int64_t(TREE_HASH_MIN_CHUNK_SIZE)) {
+		throw BinderException("xxh3_128_tree: chunk_size must be at least %d bytes", TREE_HASH_MIN_CHUNK_SIZE);
+	}
+	return make_uniq<TreeHashBindData>(NumericCast<idx_t>(chunk_size));
+}
+
+inline void TreeHashFunction(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<TreeHashBindData>();
+	auto &context = state.GetContext();
+	UnaryExecutor::Execute<string_t, uhugeint_t>(args.data[0], result, args.size(), [&](const string_t &input) {
+		return TreeHash(context, input, bind_data.chunk_size);
+	});
+}
+
+} // namespace
+
+void RegisterTreeHashFunctions(ExtensionLoader &loader) {
+	ScalarFunctionSet tree_hash_set("xxh3_128_tree");
+	for (auto &data_type : {LogicalType::BLOB, LogicalType::VARCHAR}) {
+		tree_hash_set.AddFunction(ScalarFunction({data_type}, LogicalType::UHUGEINT, TreeHashFunction, TreeHashBind));
+		tree_hash_set.AddFunction(ScalarFunction({data_type, LogicalType::BIGINT}, LogicalType::UHUGEINT,
+		                                         TreeHashFunction, TreeHashBind));
+	}
+	CreateScalarFunctionInfo tree_hash_info(tree_hash_set);
+	tree_hash_info.descriptions.push_back(
+	    {/* parameter_types */ {LogicalType::BLOB, LogicalType::BIGINT},
+	     /* parameter_names */ {"data", "chunk_size"},
+	     /* description */
+	     "Computes a 128-bit xxHash3 tree hash of a single large value: chunks of chunk_size bytes (default 1 MiB) "
+	     "are hashed in parallel and their digests hashed together. The result depends only on the data and "
+	     "chunk_size, not on the number of threads, and differs from xxh3_128",
+	     /* examples */ {"xxh3_128_tree(content)", "xxh3_128_tree(content, 4194304)"},
+	     /* categories */ {"hash"}});
+	loader.RegisterFunction(tree_hash_info);
+}
+
+} // namespace duckdb